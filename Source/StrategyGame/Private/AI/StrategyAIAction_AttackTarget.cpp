@@ -88,7 +88,7 @@ void UStrategyAIAction_AttackTarget::MoveCloser()
 	{
 		UE_VLOG(MyAIController.Get(), LogStrategyAI, Log, TEXT("Let's move closer")); 
 		bMovingToTarget = true;
-		MyAIController->MoveToActor(TargetActor.Get(), 0.9 * AttackDistance);
+		MyAIController->MoveToActorCached(TargetActor.Get(), 0.9 * AttackDistance);
 	}
 }
 
@@ -101,6 +101,15 @@ void UStrategyAIAction_AttackTarget::OnMoveCompleted()
 	}
 }
 
+void UStrategyAIAction_AttackTarget::OnPathUpdated(EPathUpdate::Type inType)
+{
+	if (inType != EPathUpdate::Update)
+	{
+		UE_VLOG(MyAIController.Get(), LogStrategyAI, Log, TEXT("Can't find path to target")); 
+		bMovingToTarget = false;
+	}
+}
+
 void UStrategyAIAction_AttackTarget::NotifyBump(FHitResult const& Hit)
 {
 	check(MyAIController.IsValid());
@@ -110,6 +119,7 @@ void UStrategyAIAction_AttackTarget::NotifyBump(FHitResult const& Hit)
 	if (HitChar != NULL && AStrategyGameMode::OnEnemyTeam(HitChar, MyAIController->GetPawn()) && bMovingToTarget)
 	{
 		bMovingToTarget = false;
+		MyAIController->AbortPendingPathRequest();
 		if (MyAIController->GetPathFollowingComponent())
 		{
 			MyAIController->GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::OwnerFinished);
@@ -133,6 +143,10 @@ void UStrategyAIAction_AttackTarget::Activate()
 	FOnMovementEvent MovementDelegate;
 	MovementDelegate.BindUObject(this, &UStrategyAIAction_AttackTarget::OnMoveCompleted);
 	MyAIController->RegisterMovementEventDelegate(MovementDelegate);
+
+	FOnPathEvent PathDelegate;
+	PathDelegate.BindUObject(this, &UStrategyAIAction_AttackTarget::OnPathUpdated);
+	MyAIController->RegisterPathEventDelegate(PathDelegate);
 }
 
 bool UStrategyAIAction_AttackTarget::IsSafeToAbort() const
@@ -145,14 +159,19 @@ void UStrategyAIAction_AttackTarget::Abort()
 	Super::Abort();
 	check(MyAIController.IsValid());
 
-	if (bMovingToTarget && MyAIController->GetPathFollowingComponent())
+	if (bMovingToTarget)
 	{
-		MyAIController->GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::OwnerFinished);
+		MyAIController->AbortPendingPathRequest();
+		if (MyAIController->GetPathFollowingComponent())
+		{
+			MyAIController->GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::OwnerFinished);
+		}
 	}
 	bMovingToTarget = false;
 	MyAIController->ClearFocus(EAIFocusPriority::Gameplay);
 	MyAIController->UnregisterBumpEventDelegate();
 	MyAIController->UnregisterMovementEventDelegate();
+	MyAIController->UnregisterPathEventDelegate();
 }
 
 bool UStrategyAIAction_AttackTarget::ShouldActivate() const
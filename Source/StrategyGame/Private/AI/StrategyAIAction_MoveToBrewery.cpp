@@ -5,11 +5,11 @@
 #include "StrategyBuilding_Brewery.h"
 #include "StrategyAIAction_MoveToBrewery.h"
 #include "StrategyAIDirector.h"
-#include "NavigationPathGenerator.h"
+#include "StrategyFlowFieldSubsystem.h"
 #include "VisualLogger/VisualLogger.h"
 
 UStrategyAIAction_MoveToBrewery::UStrategyAIAction_MoveToBrewery(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer), TargetAcceptanceRadius(150), Destination(FVector::ZeroVector), bIsMoving(false), NotMovingFromTime(0)
+	: Super(ObjectInitializer), TargetAcceptanceRadius(150), Destination(FVector::ZeroVector), bIsMoving(false), bFollowsFlowField(false), bPathFailed(false), NotMovingFromTime(0)
 {
 }
 
@@ -24,12 +24,18 @@ void UStrategyAIAction_MoveToBrewery::Abort()
 	Super::Abort();
 
 	bIsMoving = false;
+	bFollowsFlowField = false;
+	bPathFailed = false;
 	Destination = FVector::ZeroVector;
+	DestinationActor = nullptr;
+	MyAIController->ClearFocus(EAIFocusPriority::Move);
+	MyAIController->AbortPendingPathRequest();
 	if (MyAIController->GetPathFollowingComponent())
 	{
 		MyAIController->GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::OwnerFinished);
 	}
 	MyAIController->UnregisterMovementEventDelegate();
+	MyAIController->UnregisterPathEventDelegate();
 }
 
 void UStrategyAIAction_MoveToBrewery::Activate()
@@ -38,6 +44,13 @@ void UStrategyAIAction_MoveToBrewery::Activate()
 	Super::Activate();
 
 	NotMovingFromTime = 0;
+	bPathFailed = false;
+
+	// register first, cached paths start moving right away
+	FOnPathEvent PathDelegate;
+	PathDelegate.BindUObject(this, &UStrategyAIAction_MoveToBrewery::OnPathUpdated);
+	MyAIController->RegisterPathEventDelegate(PathDelegate);
+
 	// find brewery base and cache it's destination
 	const FPlayerData* TeamData = MyAIController->GetTeamData();
 	if (TeamData != NULL && TeamData->Brewery != NULL && TeamData->Brewery->GetAIDirector() != NULL)
@@ -47,7 +60,14 @@ void UStrategyAIAction_MoveToBrewery::Activate()
 		{
 			bIsMoving = true;
 			Destination = Actor->GetActorLocation();
-			MyAIController->MoveToLocation(Destination, TargetAcceptanceRadius, true, true, true);
+			DestinationActor = Actor;
+
+			// all minions share one field toward enemy brewery, fall back to own path when not covered by it
+			bFollowsFlowField = UStrategyFlowFieldSubsystem::IsEnabled() && FollowFlowField();
+			if (!bFollowsFlowField)
+			{
+				RequestPathMove();
+			}
 		}
 	}
 
@@ -56,11 +76,64 @@ void UStrategyAIAction_MoveToBrewery::Activate()
 	MyAIController->RegisterMovementEventDelegate(MovementDelegate);
 }
 
+void UStrategyAIAction_MoveToBrewery::RequestPathMove()
+{
+	// result of previous request will start the move
+	if (!MyAIController->HasPendingPathRequest())
+	{
+		MyAIController->MoveToLocationCached(Destination, TargetAcceptanceRadius);
+	}
+}
+
+bool UStrategyAIAction_MoveToBrewery::FollowFlowField()
+{
+	APawn* const MyPawn = MyAIController->GetPawn();
+	UStrategyFlowFieldSubsystem* const FlowFields = MyAIController->GetWorld()->GetSubsystem<UStrategyFlowFieldSubsystem>();
+	if (MyPawn == NULL || FlowFields == NULL)
+	{
+		return false;
+	}
+
+	const FVector PawnLocation = MyPawn->GetActorLocation();
+	FVector Direction;
+	if (!FlowFields->GetFlowDirection(DestinationActor.Get(), PawnLocation, Direction))
+	{
+		return false;
+	}
+
+	MyAIController->SetFocalPoint(PawnLocation + Direction * 500.0f, EAIFocusPriority::Move);
+	MyPawn->AddMovementInput(Direction, 1.0f);
+	return true;
+}
+
 bool UStrategyAIAction_MoveToBrewery::Tick(float DeltaTime)
 {
+	if (bPathFailed && MyAIController.IsValid())
+	{
+		Abort();
+	}
+
+	if (bIsMoving && bFollowsFlowField && MyAIController.IsValid())
+	{
+		const APawn* const MyPawn = MyAIController->GetPawn();
+		if (MyPawn != NULL && (Destination - MyPawn->GetActorLocation()).Size2D() <= TargetAcceptanceRadius)
+		{
+			MyAIController->ClearFocus(EAIFocusPriority::Move);
+			OnMoveCompleted();
+		}
+		else if (!FollowFlowField())
+		{
+			// left the field (or it was rebuilt without us), continue on regular path
+			bFollowsFlowField = false;
+			MyAIController->ClearFocus(EAIFocusPriority::Move);
+			RequestPathMove();
+		}
+	}
+
 	if (bIsMoving && MyAIController.IsValid())
 	{
-		const bool bNoMove = (MyAIController->GetMoveStatus() != EPathFollowingStatus::Moving);
+		const bool bNoMove = bFollowsFlowField ? (MyAIController->GetPawn() == NULL || MyAIController->GetPawn()->GetVelocity().SizeSquared2D() < 1.0f)
+			: (MyAIController->GetMoveStatus() != EPathFollowingStatus::Moving && !MyAIController->HasPendingPathRequest());
 		if (!bNoMove)
 		{
 			NotMovingFromTime = 0;
@@ -105,12 +178,14 @@ void UStrategyAIAction_MoveToBrewery::OnMoveCompleted()
 	bIsMoving = false;
 }
 
-void UStrategyAIAction_MoveToBrewery::OnPathUpdated(INavigationPathGenerator* PathGenerator, EPathUpdate::Type inType)
+void UStrategyAIAction_MoveToBrewery::OnPathUpdated(EPathUpdate::Type inType)
 {
 	check(MyAIController.IsValid());
 	if (inType != EPathUpdate::Update)
 	{
 		UE_VLOG(MyAIController.Get(), LogStrategyAI, Log, TEXT("WARRNING, OnPathUpdated with error - PathUpdateTyp %d"), int32(inType)); 
-		Abort();
+
+		// called through path event delegate that Abort unbinds, leave it to next tick
+		bPathFailed = true;
 	}
 }
@@ -6,12 +6,27 @@
 #include "StrategyAISensingComponent.h"
 #include "StrategyAIAction_AttackTarget.h"
 #include "StrategyAIAction_MoveToBrewery.h"
+#include "StrategyTargetingSubsystem.h"
+#include "StrategyPathCacheSubsystem.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "StrategySimProfiler.h"
+#include "NavigationSystem.h"
 #include "VisualLogger/VisualLogger.h"
 
 DEFINE_LOG_CATEGORY(LogStrategyAI);
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI decisions (full LOD)"), STAT_StrategyAIDecisionsFull, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI decisions (reduced LOD)"), STAT_StrategyAIDecisionsReduced, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI decisions skipped"), STAT_StrategyAIDecisionsSkipped, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI async path requests"), STAT_StrategyAsyncPathRequests, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI async path requests aborted"), STAT_StrategyAsyncPathAborts, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarAILODEnabled(TEXT("Strategy.AI.LOD.Enabled"), 1, TEXT("If set, AI controllers which are not engaged make decisions at reduced rate."));
+static TAutoConsoleVariable<float> CVarAILODReducedRate(TEXT("Strategy.AI.LOD.ReducedRate"), 4.0f, TEXT("Decisions per second of AI controllers in reduced LOD tier."));
+static TAutoConsoleVariable<float> CVarAILODCameraDistance(TEXT("Strategy.AI.LOD.CameraDistance"), 3000.0f, TEXT("AI controllers further from camera focal point than this drop to reduced LOD tier, unless engaged."));
+
 AStrategyAIController::AStrategyAIController(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer), bLogicEnabled(true)
+	: Super(ObjectInitializer), bDoAsyncPathfinding(true), PendingPathQueryId(INVALID_NAVQUERYID), bLogicEnabled(true), LODTier(EStrategyAILOD::Full), NextDecisionTime(0.0f), TeamRegistry(NULL), TargetingSlot(INDEX_NONE)
 {
 	SensingComponent = CreateDefaultSubobject<UStrategyAISensingComponent>(TEXT("SensingComp"));
 
@@ -29,13 +44,22 @@ void AStrategyAIController::OnPossess(APawn* inPawn)
 {
 	Super::OnPossess(inPawn);
 	
-	/** Create instances of our possible actions */
-	AllActions.Reset();
-	for(int32 Idx=0; Idx < AllowedActions.Num(); Idx++ )
+	/** Create instances of our possible actions, recycled controller keeps the ones it already has */
+	bool bHasAllActions = (AllActions.Num() == AllowedActions.Num());
+	for (int32 Idx = 0; bHasAllActions && Idx < AllActions.Num(); Idx++)
+	{
+		bHasAllActions = AllActions[Idx] != NULL && AllActions[Idx]->GetClass() == AllowedActions[Idx];
+	}
+
+	if (!bHasAllActions)
 	{
-		UStrategyAIAction* Action = NewObject<UStrategyAIAction>(this, AllowedActions[Idx]);
-		Action->SetController(this);
-		AllActions.Add(Action);
+		AllActions.Reset();
+		for(int32 Idx=0; Idx < AllowedActions.Num(); Idx++ )
+		{
+			UStrategyAIAction* Action = NewObject<UStrategyAIAction>(this, AllowedActions[Idx]);
+			Action->SetController(this);
+			AllActions.Add(Action);
+		}
 	}
 
 	AStrategyChar* const MyChar = Cast<AStrategyChar>(GetPawn());
@@ -44,23 +68,40 @@ void AStrategyAIController::OnPossess(APawn* inPawn)
 		MyChar->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
 	}
 
+	UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	if (Targeting != NULL)
+	{
+		Targeting->RegisterController(this);
+	}
+
+	TeamRegistry = GetWorld()->GetSubsystem<UStrategyTeamRegistry>();
+	if (TeamRegistry != NULL)
+	{
+		TeamRegistry->SetTeam(this, GetTeamNum());
+	}
+
+	// spread reduced rate decisions of units spawned together
+	LODTier = EStrategyAILOD::Full;
+	NextDecisionTime = GetWorld()->GetTimeSeconds() + FMath::Frac(GetUniqueID() * 0.618034f) / FMath::Max(CVarAILODReducedRate.GetValueOnGameThread(), 0.1f);
+
 	SetActorTickEnabled(true);
 	EnableLogic(true);
 }
 
 void AStrategyAIController::OnUnPossess()
 {
-	if (CurrentTarget != NULL)
+	AbortPendingPathRequest();
+
+	// releases our claim and claims on us
+	UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	if (Targeting != NULL)
 	{
-		const APawn* TargetPawn = Cast<APawn>(CurrentTarget);
-		if (TargetPawn != NULL)
-		{
-			AStrategyAIController* const AITarget = Cast<AStrategyAIController>(TargetPawn->Controller);
-			if (AITarget != NULL)
-			{
-				AITarget->UnClaimAsTarget(this);
-			}
-		}
+		Targeting->UnregisterController(this);
+	}
+
+	if (TeamRegistry != NULL)
+	{
+		TeamRegistry->RemoveActor(this);
 	}
 
 	SetActorTickEnabled(false);
@@ -74,6 +115,37 @@ uint8 AStrategyAIController::GetTeamNum() const
 	return (MyChar != NULL) ? MyChar->GetTeamNum() : EStrategyTeam::Unknown;
 }
 
+void AStrategyAIController::OnPooled()
+{
+	if (GetPawn() != NULL)
+	{
+		UnPossess();
+	}
+
+	if (CurrentAction != NULL)
+	{
+		CurrentAction->Abort();
+		CurrentAction = NULL;
+	}
+
+	AbortPendingPathRequest();
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	CurrentTarget = NULL;
+	AllTargets.Reset();
+	SensingComponent->ForgetTargets();
+	SensingComponent->SetSensingUpdatesEnabled(false);
+
+	SetActorTickEnabled(false);
+	EnableLogic(false);
+}
+
+void AStrategyAIController::OnUnpooled()
+{
+	// everything else is set up when new pawn is possessed
+	SensingComponent->SetSensingUpdatesEnabled(true);
+}
+
 void AStrategyAIController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result)
 {
 	if (CurrentAction != NULL && !Result.IsInterrupted())
@@ -137,12 +209,14 @@ bool AStrategyAIController::IsTargetValid(AActor* InActor) const
 		}
 	}
 
-	if ( TestChar && (TestChar->GetHealth() > 0) && AStrategyGameMode::OnEnemyTeam(TestChar, this) )
+	if (TestChar == NULL || TestChar->GetHealth() <= 0)
 	{
-		return true;
+		return false;
 	}
 
-	return false;
+	const EStrategyTeamRelation::Type Relation = (TeamRegistry != NULL && UStrategyTeamRegistry::IsEnabled()) ?
+		TeamRegistry->GetRelation(TestChar, this) : UStrategyTeamRegistry::GetRelationByInterface(TestChar, this);
+	return Relation == EStrategyTeamRelation::Enemy;
 }
 
 void AStrategyAIController::SelectTarget()
@@ -152,111 +226,47 @@ void AStrategyAIController::SelectTarget()
 		return;
 	}
 
-	float BestUnitScore = 10000;
-	const FVector PawnLocation = GetPawn()->GetActorLocation();
-
-	AActor* BestUnit = NULL;
-	for (int32 Idx = 0; Idx < SensingComponent->KnownTargets.Num(); Idx++)
-	{
-		AActor* const TestTarget = SensingComponent->KnownTargets[Idx].Get();
-		if (TestTarget == NULL || !IsTargetValid(TestTarget) )
-		{
-			continue;
-		}
-
-		/** don't care about targets with disabled logic */
-		const APawn* TestPawn = Cast<APawn>(TestTarget);
-		const AStrategyAIController *AITarget = (TestPawn ? Cast<AStrategyAIController>(TestPawn->Controller) : NULL);
-		if (AITarget != NULL && !AITarget->IsLogicEnabled())
-		{
-			continue;
-		}
-
-		float TargetScore = (PawnLocation - TestTarget->GetActorLocation()).SizeSquared();
-		if (CurrentTarget == TestTarget && TestTarget->IsA(AStrategyChar::StaticClass()) )
-		{
-			TargetScore -= FMath::Square(300.0f);
-		}
-
-		if (AITarget != NULL)
-		{
-			if (AITarget->IsClaimedBy(this))
-			{
-				TargetScore -= FMath::Square(300.0f);
-			}
-			else
-			{
-				TargetScore += AITarget->GetNumberOfAttackers() * FMath::Square(900.0f);
-			}
-		}
-
-		if (BestUnit == NULL || BestUnitScore > TargetScore)
-		{
-			BestUnitScore = TargetScore;
-			BestUnit = TestTarget;
-		}
-	}
-
-	const AActor* OldTarget = CurrentTarget;
-	CurrentTarget = BestUnit;
-	if (CurrentTarget != NULL && OldTarget != CurrentTarget)
+	UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	if (Targeting != NULL)
 	{
-		const APawn* OldTargetPawn = Cast<const APawn>(OldTarget);
-		AStrategyAIController* AITarget = OldTargetPawn != NULL ? Cast<AStrategyAIController>(OldTargetPawn->Controller) : NULL;
-		if (AITarget != NULL)
-		{
-			AITarget->UnClaimAsTarget(this);
-		}
-
-		APawn* const CurrentTargetPawn = Cast<APawn>(CurrentTarget);
-		AITarget = (CurrentTargetPawn ? Cast<AStrategyAIController>(CurrentTargetPawn->Controller) : NULL);
-		if (AITarget != NULL)
-		{
-			AITarget->ClaimAsTarget(this);
-		}
+		Targeting->SelectTarget(this);
 	}
-
-	UE_VLOG(this, LogStrategyAI, Log, TEXT("Selected target: %s"), CurrentTarget != NULL ? *CurrentTarget->GetName() : TEXT("NONE") ); 
 }
 
 void AStrategyAIController::ClaimAsTarget(TWeakObjectPtr<AStrategyAIController> InController)
 {
-	ClaimedBy.AddUnique(InController);
+	UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	if (Targeting != NULL)
+	{
+		Targeting->ClaimTarget(InController.Get(), this);
+	}
 }
 
 void AStrategyAIController::UnClaimAsTarget(TWeakObjectPtr<AStrategyAIController> InController)
 {
-	for (int32 Idx = ClaimedBy.Num() - 1; Idx >= 0; Idx--)
+	UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	if (Targeting != NULL)
 	{
-		const AStrategyAIController* TestC = Cast<AStrategyAIController>(ClaimedBy[Idx].Get());
-		if (TestC != NULL && TestC == InController.Get())
-		{
-			ClaimedBy.RemoveAt(Idx);
-		}
+		Targeting->UnClaimTarget(InController.Get(), this);
 	}
 }
 
 bool AStrategyAIController::IsClaimedBy(TWeakObjectPtr<AStrategyAIController> InController) const
 {
-	for (int32 Idx = ClaimedBy.Num() - 1; Idx >= 0; Idx--)
-	{
-		const AStrategyAIController* TestC = Cast<AStrategyAIController>(ClaimedBy[Idx].Get());
-		if (TestC != NULL && TestC == InController.Get())
-		{
-			return true;
-		}
-	}
-
-	return false;
+	const UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	return Targeting != NULL && Targeting->IsClaimedBy(this, InController.Get());
 }
 
 int32 AStrategyAIController::GetNumberOfAttackers() const
 {
-	return ClaimedBy.Num();
+	const UStrategyTargetingSubsystem* const Targeting = GetWorld()->GetSubsystem<UStrategyTargetingSubsystem>();
+	return Targeting != NULL ? Targeting->GetNumberOfAttackers(this) : 0;
 }
 
 void AStrategyAIController::Tick(float DeltaTime)
 {
+	STRATEGY_SIM_PROFILE_SCOPE(GetWorld(), EStrategySimStat::AI);
+
 	const AStrategyChar* MyChar = Cast<AStrategyChar>(GetPawn());
 	if (!IsLogicEnabled() || MyChar == NULL || (MyChar != NULL && MyChar->GetHealth() <= 0))
 	{
@@ -279,6 +289,25 @@ void AStrategyAIController::Tick(float DeltaTime)
 		CurrentAction = NULL;
 	}
 
+	// units without anything to do don't need to think every frame
+	UpdateLODTier();
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	if (LODTier == EStrategyAILOD::Reduced && CurrentAction != NULL && CurrentTime < NextDecisionTime)
+	{
+		INC_DWORD_STAT(STAT_StrategyAIDecisionsSkipped);
+		return;
+	}
+
+	NextDecisionTime = CurrentTime + 1.0f / FMath::Max(CVarAILODReducedRate.GetValueOnGameThread(), 0.1f);
+	if (LODTier == EStrategyAILOD::Full)
+	{
+		INC_DWORD_STAT(STAT_StrategyAIDecisionsFull);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_StrategyAIDecisionsReduced);
+	}
+
 	// select best action to execute
 	const bool bCanBreakCurrentAction = CurrentAction != NULL ? CurrentAction->IsSafeToAbort() : true;
 	if (bCanBreakCurrentAction)
@@ -312,6 +341,151 @@ void AStrategyAIController::Tick(float DeltaTime)
 	SelectTarget();
 }
 
+void AStrategyAIController::UpdateLODTier()
+{
+	if (CVarAILODEnabled.GetValueOnGameThread() == 0 || CurrentTarget != NULL)
+	{
+		LODTier = EStrategyAILOD::Full;
+		return;
+	}
+
+	bool bNearCamera = true;
+	const AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+	if (MyGameState != NULL && MyGameState->bHasCameraFocalLocation)
+	{
+		const float MaxDistance = CVarAILODCameraDistance.GetValueOnGameThread();
+		bNearCamera = FVector::DistSquared2D(GetPawn()->GetActorLocation(), MyGameState->CameraFocalLocation) <= FMath::Square(MaxDistance);
+	}
+
+	LODTier = (bNearCamera && SensingComponent->HasSeenTargetRecently()) ? EStrategyAILOD::Full : EStrategyAILOD::Reduced;
+}
+
+EStrategyAILOD::Type AStrategyAIController::GetLODTier() const
+{
+	return LODTier;
+}
+
+FPathFollowingRequestResult AStrategyAIController::MoveWithAsyncPath(const FAIMoveRequest& MoveRequest, const FStrategyPathCacheKey& CacheKey)
+{
+	FPathFollowingRequestResult Result;
+	Result.Code = EPathFollowingRequestResult::Failed;
+
+	UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	UPathFollowingComponent* const PathFollowing = GetPathFollowingComponent();
+	if (NavSys == NULL || PathFollowing == NULL || GetPawn() == NULL || !MoveRequest.IsValid())
+	{
+		return Result;
+	}
+
+	// same checks as MoveTo does before pathfinding
+	FAIMoveRequest AsyncMoveRequest = MoveRequest;
+	if (!AsyncMoveRequest.IsMoveToActorRequest() && AsyncMoveRequest.IsProjectingGoal())
+	{
+		FNavLocation ProjectedGoal;
+		if (!NavSys->ProjectPointToNavigation(AsyncMoveRequest.GetGoalLocation(), ProjectedGoal, INVALID_NAVEXTENT, &GetNavAgentPropertiesRef()))
+		{
+			return Result;
+		}
+		AsyncMoveRequest.UpdateGoalLocation(ProjectedGoal.Location);
+	}
+
+	if (PathFollowing->HasReached(AsyncMoveRequest))
+	{
+		Result.MoveId = PathFollowing->RequestMoveWithImmediateFinish(EPathFollowingResult::Success);
+		Result.Code = EPathFollowingRequestResult::AlreadyAtGoal;
+		return Result;
+	}
+
+	FPathFindingQuery Query;
+	if (!BuildPathfindingQuery(AsyncMoveRequest, Query))
+	{
+		return Result;
+	}
+
+	PendingPathQueryId = NavSys->FindPathAsync(GetNavAgentPropertiesRef(), Query, FNavPathQueryDelegate::CreateUObject(this, &AStrategyAIController::OnAsyncPathFound), EPathFindingMode::Regular);
+	if (PendingPathQueryId == INVALID_NAVQUERYID)
+	{
+		return Result;
+	}
+
+	PendingMoveRequest  = AsyncMoveRequest;
+	PendingPathCacheKey = CacheKey;
+	INC_DWORD_STAT(STAT_StrategyAsyncPathRequests);
+
+	// move itself starts when path is found
+	Result.Code = EPathFollowingRequestResult::RequestSuccessful;
+	return Result;
+}
+
+void AStrategyAIController::OnAsyncPathFound(uint32 QueryId, ENavigationQueryResult::Type QueryResult, FNavPathSharedPtr Path)
+{
+	// result of aborted or replaced request
+	if (QueryId != PendingPathQueryId)
+	{
+		return;
+	}
+
+	PendingPathQueryId = INVALID_NAVQUERYID;
+	if (GetPawn() == NULL || !IsLogicEnabled())
+	{
+		return;
+	}
+
+	const bool bGoalActorValid = !PendingMoveRequest.IsMoveToActorRequest() || PendingMoveRequest.GetGoalActor() != NULL;
+	if (QueryResult != ENavigationQueryResult::Success || !Path.IsValid() || !bGoalActorValid)
+	{
+		// finish move the same way MoveTo does when pathfinding fails
+		UE_VLOG(this, LogStrategyAI, Log, TEXT("Async path request failed"));
+		OnPathUpdatedDelegate.ExecuteIfBound(EPathUpdate::Failed);
+		GetPathFollowingComponent()->RequestMoveWithImmediateFinish(EPathFollowingResult::Invalid);
+		return;
+	}
+
+	if (PendingMoveRequest.IsMoveToActorRequest())
+	{
+		Path->SetGoalActorObservation(*PendingMoveRequest.GetGoalActor(), 100.0f);
+	}
+	Path->EnableRecalculationOnInvalidation(true);
+
+	const FAIRequestID MoveId = RequestMove(PendingMoveRequest, Path);
+	if (!MoveId.IsValid())
+	{
+		OnPathUpdatedDelegate.ExecuteIfBound(EPathUpdate::Failed);
+		GetPathFollowingComponent()->RequestMoveWithImmediateFinish(EPathFollowingResult::Invalid);
+		return;
+	}
+
+	UStrategyPathCacheSubsystem* const PathCache = UStrategyPathCacheSubsystem::IsEnabled() ? GetWorld()->GetSubsystem<UStrategyPathCacheSubsystem>() : NULL;
+	if (PathCache != NULL)
+	{
+		PathCache->AddPath(PendingPathCacheKey, Path);
+	}
+
+	OnPathUpdatedDelegate.ExecuteIfBound(EPathUpdate::Update);
+}
+
+bool AStrategyAIController::HasPendingPathRequest() const
+{
+	return PendingPathQueryId != INVALID_NAVQUERYID;
+}
+
+void AStrategyAIController::AbortPendingPathRequest()
+{
+	if (PendingPathQueryId == INVALID_NAVQUERYID)
+	{
+		return;
+	}
+
+	UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSys != NULL)
+	{
+		NavSys->AbortAsyncFindPathRequest(PendingPathQueryId);
+	}
+
+	PendingPathQueryId = INVALID_NAVQUERYID;
+	INC_DWORD_STAT(STAT_StrategyAsyncPathAborts);
+}
+
 void AStrategyAIController::EnableLogic(bool bEnable)
 {
 	bLogicEnabled = bEnable;
@@ -327,6 +501,72 @@ FVector AStrategyAIController::GetAdjustLocation()
 	return GetPawn() ? GetPawn()->GetActorLocation() : (RootComponent ? RootComponent->GetComponentLocation() : FVector::ZeroVector);
 }
 
+EPathFollowingRequestResult::Type AStrategyAIController::MoveToLocationCached(const FVector& Dest, float AcceptanceRadius)
+{
+	// same setup as MoveToLocation with default parameters
+	FAIMoveRequest MoveRequest(Dest);
+	MoveRequest.SetUsePathfinding(true);
+	MoveRequest.SetAllowPartialPath(bAllowPartialPaths);
+	MoveRequest.SetProjectGoalLocation(true);
+	MoveRequest.SetNavigationFilter(DefaultNavigationFilterClass);
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	MoveRequest.SetReachTestIncludesAgentRadius(true);
+	MoveRequest.SetCanStrafe(true);
+
+	return MoveWithPathCache(MoveRequest);
+}
+
+EPathFollowingRequestResult::Type AStrategyAIController::MoveToActorCached(AActor* Goal, float AcceptanceRadius)
+{
+	// same setup as MoveToActor with default parameters
+	FAIMoveRequest MoveRequest(Goal);
+	MoveRequest.SetUsePathfinding(true);
+	MoveRequest.SetAllowPartialPath(bAllowPartialPaths);
+	MoveRequest.SetNavigationFilter(DefaultNavigationFilterClass);
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	MoveRequest.SetReachTestIncludesAgentRadius(true);
+	MoveRequest.SetCanStrafe(true);
+
+	return MoveWithPathCache(MoveRequest);
+}
+
+FPathFollowingRequestResult AStrategyAIController::MoveWithPathCache(const FAIMoveRequest& MoveRequest)
+{
+	// new move replaces the one still waiting for path
+	AbortPendingPathRequest();
+
+	UStrategyPathCacheSubsystem* const PathCache = UStrategyPathCacheSubsystem::IsEnabled() ? GetWorld()->GetSubsystem<UStrategyPathCacheSubsystem>() : NULL;
+
+	FStrategyPathCacheKey CacheKey;
+	FNavPathSharedPtr Path;
+	if (PathCache != NULL && PathCache->FindPath(this, MoveRequest, CacheKey, Path))
+	{
+		FPathFollowingRequestResult Result;
+		Result.MoveId = RequestMove(MoveRequest, Path);
+		Result.Code = Result.MoveId.IsValid() ? EPathFollowingRequestResult::RequestSuccessful : EPathFollowingRequestResult::Failed;
+		return Result;
+	}
+
+	UStrategyFlowFieldSubsystem* const FlowFields = GetWorld()->GetSubsystem<UStrategyFlowFieldSubsystem>();
+	if (FlowFields != NULL)
+	{
+		FlowFields->NotifyPathRequest();
+	}
+
+	if (bDoAsyncPathfinding)
+	{
+		return MoveWithAsyncPath(MoveRequest, CacheKey);
+	}
+
+	const FPathFollowingRequestResult Result = MoveTo(MoveRequest, &Path);
+	if (PathCache != NULL && Result.Code == EPathFollowingRequestResult::RequestSuccessful)
+	{
+		PathCache->AddPath(CacheKey, Path);
+	}
+
+	return Result;
+}
+
 
 #if ENABLE_VISUAL_LOG
 
@@ -338,6 +578,7 @@ void AStrategyAIController::GrabDebugSnapshot(FVisualLogEntry* Snapshot) const
 	MyCategory.Category = TEXT("StrategyAIController");
 	MyCategory.Add(TEXT("CurrentAction"), CurrentAction != NULL ? *CurrentAction->GetName() : TEXT("NONE"));
 	MyCategory.Add(TEXT("CurrentTarget"), *GetDebugName(CurrentTarget));
+	MyCategory.Add(TEXT("LOD"), LODTier == EStrategyAILOD::Full ? TEXT("Full") : TEXT("Reduced"));
 
 	AStrategyChar* MyChar = Cast<AStrategyChar>(GetPawn());
 	if (MyChar)
@@ -374,4 +615,14 @@ void AStrategyAIController::UnregisterBumpEventDelegate()
 	OnNotifyBumpDelegate.Unbind();
 }
 
+void AStrategyAIController::RegisterPathEventDelegate(FOnPathEvent InDelegate)
+{
+	OnPathUpdatedDelegate = InDelegate;
+}
+
+void AStrategyAIController::UnregisterPathEventDelegate()
+{
+	OnPathUpdatedDelegate.Unbind();
+}
+
 
@@ -5,10 +5,19 @@
 #include "StrategyBuilding_Brewery.h"
 #include "StrategyGameBlueprintLibrary.h"
 #include "StrategyAttachment.h"
+#include "StrategyActorPoolSubsystem.h"
+#include "StrategySimProfiler.h"
+
+DECLARE_CYCLE_STAT(TEXT("Minion spawn"), STAT_StrategyMinionSpawn, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Minions spawned"), STAT_StrategyMinionsSpawned, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawn ground traces (async)"), STAT_StrategySpawnGroundTraces, STATGROUP_StrategyAI);
 
 UStrategyAIDirector::UStrategyAIDirector(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer), WaveSize(3), RadiusToSpawnOn(200), CustomScale(1.0), AnimationRate(1), NextSpawnTime(0), MyTeamNum(EStrategyTeam::Unknown)
+	: Super(ObjectInitializer), WaveSize(3), RadiusToSpawnOn(200), PoolPrewarmSize(10), SpawnMode(EStrategySpawnMode::Cadence), MaxSpawnsPerFrame(16), SpawnTimeBudget(2.0f)
+	, CustomScale(1.0), AnimationRate(1), NextSpawnTime(0), MyTeamNum(EStrategyTeam::Unknown), NextPendingSpawn(0), NumGroundTracesPending(0)
 {
+	GroundTraceDelegate.BindUObject(this, &UStrategyAIDirector::OnGroundTraceDone);
+
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
 
@@ -35,18 +44,96 @@ void  UStrategyAIDirector::SetTeamNum(uint8 inTeamNum)
 
 void UStrategyAIDirector::OnGameplayStateChange(EGameplayState::Type NewState)
 {
-	if (NewState == EGameplayState::Playing)
+	if (NewState == EGameplayState::Waiting)
 	{
+		PrewarmMinionPool();
+	}
+	else if (NewState == EGameplayState::Playing)
+	{
+		InitRandomStream();
 		Activate();
 		NextSpawnTime = 0;
 	}
 }
 
+void UStrategyAIDirector::PrewarmMinionPool()
+{
+	const AStrategyBuilding_Brewery* const Owner = Cast<AStrategyBuilding_Brewery>(GetOwner());
+	UStrategyActorPoolSubsystem* const Pool = GetWorld()->GetSubsystem<UStrategyActorPoolSubsystem>();
+	if (Owner == nullptr || Owner->MinionCharClass == nullptr || Pool == nullptr)
+	{
+		return;
+	}
+
+	// pools are shared by both breweries, so each one adds its own share
+	const AStrategyChar* const DefaultChar = Owner->MinionCharClass->GetDefaultObject<AStrategyChar>();
+	Pool->Prewarm(Owner->MinionCharClass, Pool->GetNumPooled(Owner->MinionCharClass) + PoolPrewarmSize);
+	Pool->Prewarm(DefaultChar->AIControllerClass, Pool->GetNumPooled(DefaultChar->AIControllerClass) + PoolPrewarmSize);
+}
+
+AStrategyChar* UStrategyAIDirector::SpawnMinion(UClass* MinionClass, const FVector& Location, const FRotator& Rotation)
+{
+	UStrategyActorPoolSubsystem* const Pool = GetWorld()->GetSubsystem<UStrategyActorPoolSubsystem>();
+	if (Pool == nullptr)
+	{
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AStrategyChar* const MinionChar = GetWorld()->SpawnActor<AStrategyChar>(MinionClass, Location, Rotation, SpawnInfo);
+		if (MinionChar != nullptr && MinionChar->bIsDying == false)
+		{
+			MinionChar->SpawnDefaultController();
+		}
+		return MinionChar;
+	}
+
+	AStrategyChar* const MinionChar = Pool->AcquireActor<AStrategyChar>(MinionClass, Location, Rotation);
+	if (MinionChar != nullptr && MinionChar->bIsDying == false && MinionChar->Controller == nullptr)
+	{
+		AController* const NewController = Pool->AcquireActor<AController>(MinionChar->AIControllerClass, Location, Rotation);
+		if (NewController != nullptr)
+		{
+			NewController->Possess(MinionChar);
+		}
+	}
+	return MinionChar;
+}
+
 AStrategyBuilding_Brewery* UStrategyAIDirector::GetEnemyBrewery() const
 {
 	return EnemyBrewery.Get();
 }
 
+AStrategyBuilding_Brewery* UStrategyAIDirector::FindEnemyBrewery() const
+{
+	const AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+	const AActor* const Owner = GetOwner();
+	if (MyGameState == nullptr || Owner == nullptr)
+	{
+		return nullptr;
+	}
+
+	// with more than two teams go for the closest enemy
+	AStrategyBuilding_Brewery* BestBrewery = nullptr;
+	float BestDistSq = MAX_FLT;
+	for (int32 TeamNum = EStrategyTeam::Unknown + 1; TeamNum < MyGameState->GetNumTeams(); TeamNum++)
+	{
+		const FPlayerData* const TeamData = MyGameState->GetPlayerData(TeamNum);
+		AStrategyBuilding_Brewery* const TestBrewery = TeamData ? TeamData->Brewery.Get() : nullptr;
+		if (TestBrewery != nullptr && TestBrewery->GetHealth() > 0 && AStrategyGameMode::OnEnemyTeam(Owner, TestBrewery))
+		{
+			const float DistSq = FVector::DistSquared(Owner->GetActorLocation(), TestBrewery->GetActorLocation());
+			if (DistSq < BestDistSq)
+			{
+				BestDistSq = DistSq;
+				BestBrewery = TestBrewery;
+			}
+		}
+	}
+
+	return BestBrewery;
+}
+
 void UStrategyAIDirector::SetDefaultArmor(UBlueprint* InArmor)
 {
 	DefaultArmor = InArmor ? *InArmor->GeneratedClass : nullptr;
@@ -81,38 +168,132 @@ void UStrategyAIDirector::SetBuffModifier(AStrategyChar* InChar, int32 AttackMin
 	AnimationRate = InAnimaRate;
 }
 
-struct OffsetsGeneratorHelper
+FStrategySpawnOffsets::FStrategySpawnOffsets()
+	: LastIndex(0)
 {
-	float Offset[6];
-	int32 LastIndex;
+	TArray<float> AllSlots;
+	for (int32 Idx = 0; Idx < NumOffsets; Idx++)
+	{
+		AllSlots.Add((Idx - NumOffsets/2) * 45);
+	}
 
-	OffsetsGeneratorHelper()
-		: LastIndex( FMath::RandRange(0, 5) )
+	// let's give better order for our spots
+	const int32 Indexes[NumOffsets] = {3,2,4,1,5,0};
+	for(int32 Idx = 0; Idx < NumOffsets; Idx++)
 	{
-		TArray<float> AllSlots;
-		for (int32 Idx = 0; Idx < 6; Idx++)
-		{
-			AllSlots.Add((Idx - 6/2) * 45);
-		}
+		Offset[Idx] = AllSlots[Indexes[Idx]];
+	}
+}
 
-		// let's give better order for our spots
-		const int32 Indexes[6] = {3,2,4,1,5,0};
-		for(int32 Idx = 0; Idx < 6; Idx++)
-		{
-			Offset[Idx] = AllSlots[Indexes[Idx]];
-		}
+void FStrategySpawnOffsets::Reset(FRandomStream& RandomStream)
+{
+	LastIndex = RandomStream.RandRange(0, NumOffsets - 1);
+}
+
+float FStrategySpawnOffsets::GetOffset()
+{
+	LastIndex = ++LastIndex >= NumOffsets ? 0 : LastIndex;
+	return Offset[LastIndex];
+}
+
+void UStrategyAIDirector::InitRandomStream()
+{
+	// same match seed gives each team its own, reproducible sequence
+	const AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+	const int32 MatchSeed = GameState != nullptr ? GameState->GetMatchSeed() : 0;
+	SpawnRandom.Initialize(int32(HashCombine(uint32(MatchSeed), uint32(MyTeamNum))));
+	OffsetsGenerator.Reset(SpawnRandom);
+}
+
+FVector UStrategyAIDirector::GetSlotLocation(int32 SlotIdx)
+{
+	// each row holds one minion per offset, further rows are placed in front of the brewery;
+	// rows wrap around before getting further than spawn radius from the first one, minions of earlier rows are gone by then
+	const AStrategyBuilding_Brewery* const Owner = CastChecked<AStrategyBuilding_Brewery>(GetOwner());
+	const float CapsuleRadius = Owner->MinionCharClass->GetDefaultObject<AStrategyChar>()->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
+	const float RowSpacing = FMath::Max(CapsuleRadius * CustomScale * 2.0f, KINDA_SMALL_NUMBER);
+	const int32 NumRows = FMath::Max(1, FMath::FloorToInt(RadiusToSpawnOn / RowSpacing));
+	const int32 Row = (SlotIdx / FStrategySpawnOffsets::NumOffsets) % NumRows;
+
+	const FVector X = Owner->GetTransform().GetScaledAxis( EAxis::X );
+	const FVector Y = Owner->GetTransform().GetScaledAxis( EAxis::Y );
+	return Owner->GetActorLocation() + X * (RadiusToSpawnOn + Row * RowSpacing) + Y * OffsetsGenerator.GetOffset();
+}
+
+void UStrategyAIDirector::GetGroundTrace(const FVector& SlotLocation, FVector& OutStart, FVector& OutEnd) const
+{
+	const FVector TraceOffset(0.0f,0.0f,RadiusToSpawnOn * 0.5 * CustomScale);
+	OutStart = SlotLocation + TraceOffset;
+	OutEnd   = SlotLocation - TraceOffset;
+}
+
+FVector UStrategyAIDirector::GetSpawnLocation(const FVector& SlotLocation, const FHitResult& GroundHit) const
+{
+	const AStrategyBuilding_Brewery* const Owner = CastChecked<AStrategyBuilding_Brewery>(GetOwner());
+	const float CapsuleHalfHeight = Owner->MinionCharClass->GetDefaultObject<AStrategyChar>()->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+
+	FVector Loc = SlotLocation;
+	if (GroundHit.GetActor())
+	{
+		Loc = GroundHit.Location + FVector(0.0f,0.0f,CustomScale * 10.0f);
 	}
+	return Loc + FVector( 0.0f,0.0f,CustomScale * CapsuleHalfHeight);
+}
+
+bool UStrategyAIDirector::SpawnMinionAt(const FVector& Loc)
+{
+	AStrategyBuilding_Brewery* const Owner = CastChecked<AStrategyBuilding_Brewery>(GetOwner());
+	AStrategyChar* const StrategyChar = Owner->MinionCharClass->GetDefaultObject<AStrategyChar>();
+	const float CapsuleHalfHeight = StrategyChar->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	const float CapsuleRadius     = StrategyChar->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
+	const FVector Scale(CustomScale);
 
-	float GetOffset()
+	// and spawn our minion
+	// don't continue if he died right away on spawn
+	AStrategyChar* const MinionChar = SpawnMinion(Owner->MinionCharClass, Loc, Owner->GetActorRotation());
+	if ( (MinionChar == nullptr) || (MinionChar->bIsDying == true) )
 	{
-		LastIndex = ++LastIndex >= 6 ? 0 : LastIndex;
-		return Offset[LastIndex];
+		UE_LOG(LogGame, Warning, TEXT("Failed to spawn minion.") );
+		return false;
 	}
-};
+
+	MinionChar->SetTeamNum(GetTeamNum());
+	MinionChar->GetCapsuleComponent()->SetRelativeScale3D(Scale);
+	MinionChar->GetCapsuleComponent()->SetCapsuleSize(CapsuleRadius, CapsuleHalfHeight);
+	MinionChar->GetMesh()->GlobalAnimRateScale = AnimationRate;
+
+	AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+	if (GameState != nullptr)
+	{
+		GameState->OnCharSpawned(MinionChar);
+	}
+
+	MinionChar->ApplyBuff(BuffModifier);
+	if (DefaultWeapon != nullptr)
+	{
+		UStrategyGameBlueprintLibrary::GiveWeaponFromClass(MinionChar, DefaultWeapon);
+	}
+	if (DefaultArmor != nullptr)
+	{
+		UStrategyGameBlueprintLibrary::GiveArmorFromClass(MinionChar, DefaultArmor);
+	}
+
+	INC_DWORD_STAT(STAT_StrategyMinionsSpawned);
+
+	WaveSize -= 1;
+	WaveSize = FMath::Max(WaveSize, 0);
+	if (WaveSize <= 0 && MyTeamNum==EStrategyTeam::Enemy)
+	{
+		Owner->OnWaveSpawned.Broadcast();
+	}
+
+	return true;
+}
 
 void UStrategyAIDirector::SpawnMinions()
 {
-	static OffsetsGeneratorHelper OffsetsGenerator;
+	SCOPE_CYCLE_COUNTER(STAT_StrategyMinionSpawn);
+
 	const bool bShoudSpawnNewUnits = GetWorld()->GetTimeSeconds() > NextSpawnTime;
 	if (!bShoudSpawnNewUnits)
 	{
@@ -121,98 +302,122 @@ void UStrategyAIDirector::SpawnMinions()
 
 	if (EnemyBrewery == nullptr)
 	{
-		const EStrategyTeam::Type EnemyTeamNum = (MyTeamNum == EStrategyTeam::Player ? EStrategyTeam::Enemy : EStrategyTeam::Player);
-		const FPlayerData* const EnemyTeamData = GetWorld()->GetGameState<AStrategyGameState>()->GetPlayerData(EnemyTeamNum);
-		if (EnemyTeamData != nullptr && EnemyTeamData->Brewery != nullptr)
-		{
-			EnemyBrewery = EnemyTeamData->Brewery;
-		}
+		EnemyBrewery = FindEnemyBrewery();
 	}
 
-	if(WaveSize > 0)
+	if (WaveSize <= 0 && PendingSpawns.Num() == 0)
 	{
-		// find best place on ground to spawn at
-		const AStrategyBuilding_Brewery* const Owner = Cast<AStrategyBuilding_Brewery>(GetOwner());
-		check(Owner);
-		bool bSpawnedNewMinion = false;
-		if( Owner->MinionCharClass != nullptr )
+		return;
+	}
+
+	const AStrategyBuilding_Brewery* const Owner = Cast<AStrategyBuilding_Brewery>(GetOwner());
+	check(Owner);
+	if (Owner->MinionCharClass == nullptr)
+	{
+		// If we dont have a class type we cannot spawn a minion. 
+		UE_LOG(LogGame, Warning, TEXT("No minion class specified in %s. Cannot spawn minion"), *Owner->GetName() );
+		NextSpawnTime = GetWorld()->GetTimeSeconds() + 0.1f;
+		return;
+	}
+
+	if (SpawnMode == EStrategySpawnMode::Batched)
+	{
+		SpawnMinionsBatched();
+		return;
+	}
+
+	// find best place on ground to spawn at
+	const FVector SlotLocation = GetSlotLocation(0);
+	FVector TraceStart, TraceEnd;
+	GetGroundTrace(SlotLocation, TraceStart, TraceEnd);
+
+	FHitResult Hit;
+	FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::AllStaticObjects);
+	GetWorld()->LineTraceSingleByObjectType(Hit, TraceStart, TraceEnd, ObjectParams);
+
+	if (SpawnMinionAt(GetSpawnLocation(SlotLocation, Hit)))
+	{
+		NextSpawnTime = GetWorld()->GetTimeSeconds() + SpawnRandom.FRandRange(2.0f, 3.0f);
+	}
+	else
+	{
+		// If we failed to spawn a minion try again soon
+		NextSpawnTime = GetWorld()->GetTimeSeconds() + 0.1f;
+	}
+}
+
+void UStrategyAIDirector::SpawnMinionsBatched()
+{
+	// start new wave: all slots are known up front, their ground heights are resolved by one batch of async traces
+	if (PendingSpawns.Num() == 0)
+	{
+		FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::AllStaticObjects);
+		PendingSpawns.SetNum(WaveSize);
+		NumGroundTracesPending = WaveSize;
+		NextPendingSpawn = 0;
+
+		for (int32 Idx = 0; Idx < PendingSpawns.Num(); Idx++)
 		{
-			FVector Loc     = Owner->GetActorLocation();
-			const FVector X = Owner->GetTransform().GetScaledAxis( EAxis::X );
-			const FVector Y = Owner->GetTransform().GetScaledAxis( EAxis::Y );
-			Loc += X * RadiusToSpawnOn +  Y * OffsetsGenerator.GetOffset();
-
-			FHitResult Hit;
-			const FVector Scale(CustomScale);
-			const FVector TraceOffset(0.0f,0.0f,RadiusToSpawnOn * 0.5 * Scale.Z);
-			FCollisionObjectQueryParams ObjectParams(FCollisionObjectQueryParams::AllStaticObjects);
-			GetWorld()->LineTraceSingleByObjectType(Hit, Loc + TraceOffset, Loc - TraceOffset, ObjectParams);
-			if (Hit.GetActor())
-			{
-				Loc = Hit.Location + FVector(0.0f,0.0f,Scale.Z * 10.0f);
-			}
-			AStrategyChar* StrategyChar   = Owner->MinionCharClass->GetDefaultObject<AStrategyChar>();
-			const float CapsuleHalfHeight = StrategyChar->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
-			const float CapsuleRadius     = StrategyChar->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
-			Loc = Loc + FVector( 0.0f,0.0f,Scale.Z * CapsuleHalfHeight);
-
-			// and spawn our minion
-			FActorSpawnParameters SpawnInfo;
-			SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-			// don't continue if he died right away on spawn
-			AStrategyChar* const MinionChar =  GetWorld()->SpawnActor<AStrategyChar>(Owner->MinionCharClass, Loc, Owner->GetActorRotation(), SpawnInfo);
-			if ( (MinionChar != nullptr) && (MinionChar->bIsDying == false) )
-			{
-				// Flag a successful spawn
-				bSpawnedNewMinion = true;
-
-				MinionChar->SetTeamNum(GetTeamNum());
-				MinionChar->SpawnDefaultController();
-				MinionChar->GetCapsuleComponent()->SetRelativeScale3D(Scale);
-				MinionChar->GetCapsuleComponent()->SetCapsuleSize(CapsuleRadius, CapsuleHalfHeight);
-				MinionChar->GetMesh()->GlobalAnimRateScale = AnimationRate;
-
-				AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
-				if (GameState != nullptr)
-				{
-					GameState->OnCharSpawned(MinionChar);
-				}
-
-				MinionChar->ApplyBuff(BuffModifier);
-				if (DefaultWeapon != nullptr)
-				{
-					UStrategyGameBlueprintLibrary::GiveWeaponFromClass(MinionChar, DefaultWeapon);
-				}
-				if (DefaultArmor != nullptr)
-				{
-					UStrategyGameBlueprintLibrary::GiveArmorFromClass(MinionChar, DefaultArmor);
-				}
-
-				WaveSize -= 1;
-				WaveSize = FMath::Max(WaveSize, 0);
-				if (Owner != nullptr && WaveSize <= 0 && MyTeamNum==EStrategyTeam::Enemy)
-				{
-					Owner->OnWaveSpawned.Broadcast();
-				}
-				NextSpawnTime = GetWorld()->GetTimeSeconds() + FMath::FRandRange(2.0f, 3.0f);
-			}
-			else
-			{
-				UE_LOG(LogGame, Warning, TEXT("Failed to spawn minion.") );
-			}
+			FPendingSpawn& Spawn = PendingSpawns[Idx];
+			Spawn.SlotLocation = GetSlotLocation(Idx);
+			Spawn.Location = Spawn.SlotLocation;
+			Spawn.bGroundResolved = false;
+
+			FVector TraceStart, TraceEnd;
+			GetGroundTrace(Spawn.SlotLocation, TraceStart, TraceEnd);
+			GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, TraceStart, TraceEnd, ObjectParams, FCollisionQueryParams::DefaultQueryParam, &GroundTraceDelegate, uint32(Idx));
 		}
-		else
+
+		INC_DWORD_STAT_BY(STAT_StrategySpawnGroundTraces, PendingSpawns.Num());
+		return;
+	}
+
+	if (NumGroundTracesPending > 0)
+	{
+		return;
+	}
+
+	// spawn as many as allowed this frame, always at least one so wave can't stall
+	const double StartTime = FPlatformTime::Seconds();
+	const double TimeLimit = StartTime + SpawnTimeBudget / 1000.0f;
+	const int32 SpawnLimit = FMath::Max(MaxSpawnsPerFrame, 1);
+	int32 NumSpawned = 0;
+	while (NextPendingSpawn < PendingSpawns.Num() && NumSpawned < SpawnLimit && WaveSize > 0)
+	{
+		if (!SpawnMinionAt(PendingSpawns[NextPendingSpawn].Location))
 		{
-			// If we dont have a class type we cannot spawn a minion. 
-			UE_LOG(LogGame, Warning, TEXT("No minion class specified in %s. Cannot spawn minion"), *Owner->GetName() );			
+			// try again soon
+			NextSpawnTime = GetWorld()->GetTimeSeconds() + 0.1f;
+			break;
 		}
-		// If we failed to spawn a minion try again soon
-		if( bSpawnedNewMinion == false )
+
+		NextPendingSpawn++;
+		NumSpawned++;
+		if (FPlatformTime::Seconds() > TimeLimit)
 		{
-			NextSpawnTime = GetWorld()->GetTimeSeconds() + 0.1f;
+			break;
 		}
 	}
+
+	if (NextPendingSpawn >= PendingSpawns.Num() || WaveSize <= 0)
+	{
+		PendingSpawns.Reset();
+		NextPendingSpawn = 0;
+	}
+}
+
+void UStrategyAIDirector::OnGroundTraceDone(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	const int32 Idx = int32(Data.UserData);
+	if (!PendingSpawns.IsValidIndex(Idx) || PendingSpawns[Idx].bGroundResolved)
+	{
+		return;
+	}
+
+	FPendingSpawn& Spawn = PendingSpawns[Idx];
+	Spawn.Location = GetSpawnLocation(Spawn.SlotLocation, Data.OutHits.Num() > 0 ? Data.OutHits[0] : FHitResult());
+	Spawn.bGroundResolved = true;
+	NumGroundTracesPending--;
 }
 
 void UStrategyAIDirector::RequestSpawn()
@@ -223,5 +428,7 @@ void UStrategyAIDirector::RequestSpawn()
 void UStrategyAIDirector::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	STRATEGY_SIM_PROFILE_SCOPE(GetWorld(), EStrategySimStat::AI);
 	SpawnMinions();
 }
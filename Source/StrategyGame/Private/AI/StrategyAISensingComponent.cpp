@@ -2,6 +2,16 @@
 
 #include "StrategyGame.h"
 #include "StrategyAISensingComponent.h"
+#include "StrategySpatialGrid.h"
+#include "StrategyAISensingScheduler.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight traces (sync)"), STAT_StrategySightTracesSync, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarSensingSightTraceMode(TEXT("Strategy.AI.SightTraceMode"), 0,
+	TEXT("How AI sensing checks line of sight to visible candidates.\n")
+	TEXT(" 0: no trace, view cone test only\n")
+	TEXT(" 1: synchronous line trace on game thread\n")
+	TEXT(" 2: batched async line traces, results are consumed next frame"));
 
 UStrategyAISensingComponent::UStrategyAISensingComponent(const FObjectInitializer& ObjectInitializer) 
 	: Super(ObjectInitializer)
@@ -12,6 +22,7 @@ UStrategyAISensingComponent::UStrategyAISensingComponent(const FObjectInitialize
 	bOnlySensePlayers = false;
 	bHearNoises = false;
 	bSeePawns = true;
+	LastTargetSeenTime = -BIG_NUMBER;
 }
 
 void UStrategyAISensingComponent::InitializeComponent()
@@ -19,12 +30,54 @@ void UStrategyAISensingComponent::InitializeComponent()
 	Super::InitializeComponent();
 	// set custom data from config file
 	SightRadius = SightDistance;
+
+	TeamRegistry = GetWorld() ? GetWorld()->GetSubsystem<UStrategyTeamRegistry>() : nullptr;
+}
+
+void UStrategyAISensingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetSensingUpdatesEnabled(false);
+	Super::EndPlay(EndPlayReason);
+}
+
+void UStrategyAISensingComponent::SetSensingUpdatesEnabled(const bool bEnabled)
+{
+	UStrategyAISensingScheduler* const Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UStrategyAISensingScheduler>() : nullptr;
+	bEnableSensingUpdates = bEnabled;
+
+	if (Scheduler != nullptr)
+	{
+		if (bEnabled && SensingInterval > 0.f)
+		{
+			Scheduler->RegisterSensor(this);
+		}
+		else
+		{
+			Scheduler->UnregisterSensor(this);
+		}
+	}
+}
+
+void UStrategyAISensingComponent::SetSensingInterval(const float NewSensingInterval)
+{
+	if (SensingInterval != NewSensingInterval)
+	{
+		SensingInterval = NewSensingInterval;
+		SetSensingUpdatesEnabled(bEnableSensingUpdates);
+	}
 }
 
 bool UStrategyAISensingComponent::ShouldCheckVisibilityOf(APawn *Pawn) const
 {
 	AStrategyChar* const TestChar = Cast<AStrategyChar>(Pawn);
-	return TestChar != nullptr && !TestChar->IsHidden() && TestChar->GetHealth() > 0 && AStrategyGameMode::OnEnemyTeam(Pawn, GetOwner());
+	if (TestChar == nullptr || TestChar->IsHidden() || TestChar->GetHealth() <= 0)
+	{
+		return false;
+	}
+
+	const EStrategyTeamRelation::Type Relation = (TeamRegistry != nullptr && UStrategyTeamRegistry::IsEnabled()) ?
+		TeamRegistry->GetRelation(Pawn, GetOwner()) : UStrategyTeamRegistry::GetRelationByInterface(Pawn, GetOwner());
+	return Relation == EStrategyTeamRelation::Enemy;
 }
 
 bool UStrategyAISensingComponent::CanSenseAnything() const
@@ -41,23 +94,104 @@ void UStrategyAISensingComponent::UpdateAISensing()
 		return;
 	}
 
-	for (AStrategyChar* const TestChar : TActorRange<AStrategyChar>(Owner->GetWorld()))
+	// only characters registered in spatial grid (alive) within sight radius are interesting
+	const UStrategySpatialGrid* const Grid = Owner->GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid != NULL)
 	{
-		if (!IsSensorActor(TestChar) && ShouldCheckVisibilityOf(TestChar))
+		const int32 SightTraceMode = CVarSensingSightTraceMode.GetValueOnGameThread();
+		UStrategyAISensingScheduler* const Scheduler = Owner->GetWorld()->GetSubsystem<UStrategyAISensingScheduler>();
+
+		Grid->ForEachCharInRadius(GetSensorLocation(), SightRadius, [this, SightTraceMode, Scheduler](AStrategyChar* TestChar)
 		{
-			if (CouldSeePawn(TestChar, true))
+			if (!IsSensorActor(TestChar) && ShouldCheckVisibilityOf(TestChar))
 			{
-				KnownTargets.AddUnique(TestChar);
+				if (CouldSeePawn(TestChar, true))
+				{
+					switch (SightTraceMode)
+					{
+					case 1:
+						if (HasClearSightTo(TestChar))
+						{
+							OnTargetSeen(TestChar);
+						}
+						break;
+					case 2:
+						if (Scheduler != NULL)
+						{
+							Scheduler->QueueSightCheck(this, TestChar);
+						}
+						break;
+					default:
+						OnTargetSeen(TestChar);
+						break;
+					}
+				}
 			}
-		}
+		});
 	}
+}
 
-	for (int32 i = KnownTargets.Num() - 1; i >= 0; i--)
+bool UStrategyAISensingComponent::HasClearSightTo(const AStrategyChar* TestChar) const
+{
+	INC_DWORD_STAT(STAT_StrategySightTracesSync);
+
+	const AController* const OwnerController = Cast<AController>(GetOwner());
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AISightTrace), false, TestChar);
+	if (OwnerController != NULL)
 	{
-		const AStrategyChar* TestChar = Cast<AStrategyChar>(KnownTargets[i].Get());
-		if (TestChar == NULL)
-		{
-			KnownTargets.RemoveAt(i);
-		}
+		TraceParams.AddIgnoredActor(OwnerController->GetPawn());
+	}
+
+	return !GetWorld()->LineTraceTestByChannel(GetSensorLocation(), TestChar->GetActorLocation(), ECC_Visibility, TraceParams);
+}
+
+void UStrategyAISensingComponent::OnTargetSeen(AStrategyChar* SeenChar)
+{
+	KnownTargets.Add(GetWorld()->GetSubsystem<UStrategySpatialGrid>(), SeenChar);
+	LastTargetSeenTime = GetWorld()->GetTimeSeconds();
+}
+
+bool UStrategyAISensingComponent::HasSeenTargetRecently() const
+{
+	// async sight checks report one frame later, two intervals leave enough slack
+	return GetWorld()->GetTimeSeconds() - LastTargetSeenTime <= SensingInterval * 2.0f;
+}
+
+void UStrategyAISensingComponent::ForgetTargets()
+{
+	KnownTargets.Reset();
+	LastTargetSeenTime = -BIG_NUMBER;
+}
+
+void FStrategyKnownTargets::Add(const UStrategySpatialGrid* InGrid, AStrategyChar* InChar)
+{
+	if (InGrid == nullptr)
+	{
+		return;
+	}
+
+	const FStrategyGridHandle Handle = InGrid->GetHandle(InChar);
+	if (Handle.Slot == INDEX_NONE)
+	{
+		return;
 	}
+
+	Grid = InGrid;
+
+	// same slot always maps to same entry: refresh serial, which also replaces expired character
+	const int32* const TargetIdx = SlotToTarget.Find(Handle.Slot);
+	if (TargetIdx != nullptr)
+	{
+		Targets[*TargetIdx] = Handle;
+	}
+	else
+	{
+		SlotToTarget.Add(Handle.Slot, Targets.Add(Handle));
+	}
+}
+
+void FStrategyKnownTargets::Reset()
+{
+	Targets.Reset();
+	SlotToTarget.Reset();
 }
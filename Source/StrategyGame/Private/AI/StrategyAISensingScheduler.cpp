@@ -0,0 +1,242 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyAISensingScheduler.h"
+#include "StrategyAISensingComponent.h"
+#include "StrategySimProfiler.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sensing scheduler"), STAT_StrategySensingScheduler, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensors updated"), STAT_StrategySensorsUpdated, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensors deferred"), STAT_StrategySensorsDeferred, STATGROUP_StrategyAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sensors registered"), STAT_StrategySensorsRegistered, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight traces (async)"), STAT_StrategySightTracesAsync, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarSensingBudgetUs(TEXT("Strategy.AI.SensingBudgetUs"), 500, TEXT("Time budget for AI sensing updates per frame, in microseconds. Sensors over budget are deferred to next frame."));
+
+UStrategyAISensingScheduler::UStrategyAISensingScheduler()
+	: Cursor(0), NumRemoved(0), bUpdatingSensors(false), RegisterCounter(0), SightBatchParity(0)
+{
+	SightTraceDelegate.BindUObject(this, &UStrategyAISensingScheduler::OnSightTraceDone);
+}
+
+void UStrategyAISensingScheduler::Deinitialize()
+{
+	Sensors.Reset();
+	Cursor = 0;
+	NumRemoved = 0;
+
+	QueuedSightChecks.Reset();
+	PendingSightChecks[0].Reset();
+	PendingSightChecks[1].Reset();
+
+	Super::Deinitialize();
+}
+
+bool UStrategyAISensingScheduler::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyAISensingScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyAISensingScheduler, STATGROUP_Tickables);
+}
+
+void UStrategyAISensingScheduler::RegisterSensor(UStrategyAISensingComponent* Sensor)
+{
+	if (Sensor == nullptr)
+	{
+		return;
+	}
+
+	for (int32 Idx = 0; Idx < Sensors.Num(); Idx++)
+	{
+		if (Sensors[Idx].Sensor == Sensor)
+		{
+			return;
+		}
+	}
+
+	// spread initial updates over whole interval (golden ratio sequence), so sensors spawned together don't update together
+	const float Phase = FMath::Frac(RegisterCounter++ * 0.618034f);
+
+	FScheduledSensor NewSensor;
+	NewSensor.Sensor         = Sensor;
+	NewSensor.NextUpdateTime = GetWorld()->GetTimeSeconds() + Sensor->SensingInterval * Phase;
+	Sensors.Add(NewSensor);
+}
+
+void UStrategyAISensingScheduler::UnregisterSensor(UStrategyAISensingComponent* Sensor)
+{
+	for (int32 Idx = 0; Idx < Sensors.Num(); Idx++)
+	{
+		if (Sensors[Idx].Sensor == Sensor)
+		{
+			// updated sensor can unregister others (e.g. by killing their owners), indices must stay valid until update is done
+			if (bUpdatingSensors)
+			{
+				Sensors[Idx].Sensor = nullptr;
+				NumRemoved++;
+				return;
+			}
+
+			Sensors.RemoveAtSwap(Idx, 1, false);
+			if (Cursor >= Sensors.Num())
+			{
+				Cursor = 0;
+			}
+			return;
+		}
+	}
+}
+
+void UStrategyAISensingScheduler::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategySensingScheduler);
+	STRATEGY_SIM_PROFILE_SCOPE(GetWorld(), EStrategySimStat::Sensing);
+	SET_DWORD_STAT(STAT_StrategySensorsRegistered, Sensors.Num());
+
+	const int32 NumSensors = Sensors.Num();
+	if (NumSensors == 0)
+	{
+		FlushSightChecks();
+		return;
+	}
+
+	const float CurrentTime  = GetWorld()->GetTimeSeconds();
+	const double BudgetSec   = FMath::Max(0, CVarSensingBudgetUs.GetValueOnGameThread()) / 1000000.0;
+	const double StartTime   = FPlatformTime::Seconds();
+
+	int32 NumUpdated  = 0;
+	int32 NumDeferred = 0;
+	int32 NextCursor  = Cursor;
+	bool bOverBudget  = false;
+
+	// sensors registered during update are appended and wait for next frame, unregistered ones are removed after it
+	bUpdatingSensors = true;
+	for (int32 Step = 0; Step < NumSensors; Step++)
+	{
+		const int32 Idx = (Cursor + Step) % NumSensors;
+		FScheduledSensor& Entry = Sensors[Idx];
+		if (Entry.Sensor == nullptr || Entry.NextUpdateTime > CurrentTime)
+		{
+			continue;
+		}
+
+		// always update at least one sensor per frame, so we can't starve
+		if (!bOverBudget && NumUpdated > 0 && (FPlatformTime::Seconds() - StartTime) > BudgetSec)
+		{
+			bOverBudget = true;
+			NextCursor  = Idx;
+		}
+
+		if (bOverBudget)
+		{
+			NumDeferred++;
+			continue;
+		}
+
+		UStrategyAISensingComponent* const Sensor = Entry.Sensor;
+		Entry.NextUpdateTime = CurrentTime + Sensor->SensingInterval;
+
+		const AActor* const Owner = Sensor->GetOwner();
+		if (IsValid(Owner) && Sensor->CanSenseAnything())
+		{
+			Sensor->UpdateAISensing();
+			NumUpdated++;
+		}
+	}
+	bUpdatingSensors = false;
+
+	// deferred sensors are first in line next frame
+	Cursor = bOverBudget ? NextCursor : (Cursor + 1) % NumSensors;
+	CompactSensors();
+
+	INC_DWORD_STAT_BY(STAT_StrategySensorsUpdated, NumUpdated);
+	INC_DWORD_STAT_BY(STAT_StrategySensorsDeferred, NumDeferred);
+
+	FlushSightChecks();
+}
+
+void UStrategyAISensingScheduler::CompactSensors()
+{
+	for (int32 Idx = Sensors.Num() - 1; Idx >= 0 && NumRemoved > 0; Idx--)
+	{
+		if (Sensors[Idx].Sensor == nullptr)
+		{
+			Sensors.RemoveAtSwap(Idx, 1, false);
+			NumRemoved--;
+		}
+	}
+
+	if (Cursor >= Sensors.Num())
+	{
+		Cursor = 0;
+	}
+}
+
+void UStrategyAISensingScheduler::QueueSightCheck(UStrategyAISensingComponent* Sensor, AStrategyChar* Target)
+{
+	FSightCheck& NewCheck = QueuedSightChecks.AddDefaulted_GetRef();
+	NewCheck.Sensor = Sensor;
+	NewCheck.Target = Target;
+	NewCheck.Start  = Sensor->GetSensorLocation();
+	NewCheck.End    = Target->GetActorLocation();
+}
+
+void UStrategyAISensingScheduler::FlushSightChecks()
+{
+	TArray<FSightCheck>& Batch = PendingSightChecks[SightBatchParity];
+	if (Batch.Num() > 0)
+	{
+		// results of this batch should have been delivered one frame ago, drop the ones that never came back
+		Batch.Reset();
+	}
+
+	if (QueuedSightChecks.Num() == 0)
+	{
+		return;
+	}
+
+	Exchange(Batch, QueuedSightChecks);
+
+	UWorld* const World = GetWorld();
+	for (int32 Idx = 0; Idx < Batch.Num(); Idx++)
+	{
+		const FSightCheck& Check = Batch[Idx];
+		const AController* const SensorController = Check.Sensor.IsValid() ? Cast<AController>(Check.Sensor->GetOwner()) : nullptr;
+
+		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(AISightTrace), false, Check.Target.Get());
+		if (SensorController != nullptr)
+		{
+			TraceParams.AddIgnoredActor(SensorController->GetPawn());
+		}
+
+		// user data carries batch parity in highest bit and index in batch
+		const uint32 UserData = (SightBatchParity << 31) | uint32(Idx);
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Test, Check.Start, Check.End, ECC_Visibility, TraceParams, FCollisionResponseParams::DefaultResponseParam, &SightTraceDelegate, UserData);
+	}
+
+	INC_DWORD_STAT_BY(STAT_StrategySightTracesAsync, Batch.Num());
+	SightBatchParity ^= 1;
+}
+
+void UStrategyAISensingScheduler::OnSightTraceDone(const FTraceHandle& Handle, FTraceDatum& Data)
+{
+	const uint32 Parity = Data.UserData >> 31;
+	const int32 Idx     = int32(Data.UserData & 0x7fffffff);
+	if (!PendingSightChecks[Parity].IsValidIndex(Idx))
+	{
+		return;
+	}
+
+	const FSightCheck& Check = PendingSightChecks[Parity][Idx];
+	UStrategyAISensingComponent* const Sensor = Check.Sensor.Get();
+	AStrategyChar* const Target = Check.Target.Get();
+
+	// target could die while trace was in flight
+	if (Sensor != nullptr && Target != nullptr && Target->GetHealth() > 0 && FHitResult::GetFirstBlockingHit(Data.OutHits) == nullptr)
+	{
+		Sensor->OnTargetSeen(Target);
+	}
+}
@@ -0,0 +1,367 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow field build"), STAT_StrategyFlowFieldBuild, STATGROUP_StrategyAI);
+DECLARE_CYCLE_STAT(TEXT("Flow field query"), STAT_StrategyFlowFieldQuery, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI path requests"), STAT_StrategyPathRequests, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow field builds"), STAT_StrategyFlowFieldBuilds, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarFlowFieldEnabled(TEXT("Strategy.AI.FlowField"), 1, TEXT("If set, minions follow shared flow field to enemy brewery instead of requesting their own paths."));
+static TAutoConsoleVariable<float> CVarFlowFieldBuildBudget(TEXT("Strategy.AI.FlowFieldBuildBudget"), 1.0f, TEXT("Time in ms spent building flow fields per frame, 0 builds whole field in one frame."));
+
+namespace StrategyFlowField
+{
+	/** neighbour cell offsets, orthogonal first */
+	static const FIntPoint NeighbourOffsets[8] = { {1,0}, {-1,0}, {0,1}, {0,-1}, {1,1}, {-1,-1}, {1,-1}, {-1,1} };
+
+	/** index of opposite neighbour */
+	static const uint8 Opposite[8] = { 1, 0, 3, 2, 5, 4, 7, 6 };
+
+	/** cost of moving to neighbour */
+	static const uint32 StepCost[8] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+
+	/** special NextStep values */
+	static const uint8 GoalCell = 0xFE;
+	static const uint8 Unreachable = 0xFF;
+
+	/** max number of cells in each axis */
+	static const int32 MaxCellsPerAxis = 512;
+
+	/** navmesh queries between two checks of build time budget */
+	static const int32 QueriesPerTimeCheck = 32;
+}
+
+UStrategyFlowFieldSubsystem::UStrategyFlowFieldSubsystem()
+	: CellSize(200.0f), MaxStepHeight(100.0f), NumPathRequests(0), NumFieldBuilds(0), BuildSeconds(0.0), MaxBuildSliceSeconds(0.0)
+{
+}
+
+void UStrategyFlowFieldSubsystem::Deinitialize()
+{
+	Fields.Reset();
+	Super::Deinitialize();
+}
+
+bool UStrategyFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyFlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// guard against bad config values
+	CellSize = FMath::Max(CellSize, 50.0f);
+
+	UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld);
+	if (NavSys != nullptr)
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &UStrategyFlowFieldSubsystem::OnNavigationGenerationFinished);
+	}
+}
+
+bool UStrategyFlowFieldSubsystem::IsEnabled()
+{
+	return CVarFlowFieldEnabled.GetValueOnGameThread() != 0;
+}
+
+void UStrategyFlowFieldSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	InvalidateFields();
+}
+
+void UStrategyFlowFieldSubsystem::InvalidateFields()
+{
+	for (TMap<TWeakObjectPtr<const AActor>, FFlowField>::TIterator It(Fields); It; ++It)
+	{
+		It.Value().bDirty = true;
+		It.Value().Build.Reset();
+	}
+}
+
+void UStrategyFlowFieldSubsystem::NotifyPathRequest()
+{
+	NumPathRequests++;
+	INC_DWORD_STAT(STAT_StrategyPathRequests);
+}
+
+FBox UStrategyFlowFieldSubsystem::GetFieldBounds() const
+{
+	const AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+	if (MyGameState != nullptr && MyGameState->WorldBounds.IsValid)
+	{
+		return MyGameState->WorldBounds;
+	}
+
+	const UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	return NavSys != nullptr ? NavSys->GetWorldBounds() : FBox(ForceInit);
+}
+
+void UStrategyFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	bool bHasWork = false;
+	for (TMap<TWeakObjectPtr<const AActor>, FFlowField>::TIterator It(Fields); It && !bHasWork; ++It)
+	{
+		bHasWork = It.Value().bDirty || It.Value().Build.IsValid();
+	}
+
+	if (!bHasWork)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_StrategyFlowFieldBuild);
+
+	// fields share one budget, no budget means whole builds like before time slicing
+	const double StartTime = FPlatformTime::Seconds();
+	const float BudgetMs = CVarFlowFieldBuildBudget.GetValueOnGameThread();
+	const double EndTime = BudgetMs > 0.0f ? StartTime + BudgetMs / 1000.0 : 0.0;
+
+	for (TMap<TWeakObjectPtr<const AActor>, FFlowField>::TIterator It(Fields); It; ++It)
+	{
+		const AActor* const Goal = It.Key().Get();
+		if (Goal == nullptr)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		FFlowField& Field = It.Value();
+		if (Field.bDirty)
+		{
+			StartBuild(Goal, Field);
+		}
+
+		if (Field.Build.IsValid() && StepBuild(*Field.Build, EndTime))
+		{
+			// swap in finished field
+			FFlowFieldBuild& Build = *Field.Build;
+			Field.GoalLocation = Build.GoalLocation;
+			Field.Origin = Build.Origin;
+			Field.Size = Build.Size;
+			Field.NextStep = MoveTemp(Build.NextStep);
+			Field.CellHeight = MoveTemp(Build.CellHeight);
+			Field.Build.Reset();
+
+			NumFieldBuilds++;
+			INC_DWORD_STAT(STAT_StrategyFlowFieldBuilds);
+		}
+
+		if (EndTime > 0.0 && FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+	}
+
+	const double SliceSeconds = FPlatformTime::Seconds() - StartTime;
+	BuildSeconds += SliceSeconds;
+	MaxBuildSliceSeconds = FMath::Max(MaxBuildSliceSeconds, SliceSeconds);
+}
+
+void UStrategyFlowFieldSubsystem::StartBuild(const AActor* Goal, FFlowField& Field)
+{
+	using namespace StrategyFlowField;
+
+	Field.bDirty = false;
+	Field.Build.Reset();
+
+	const FBox Bounds = GetFieldBounds();
+	if (FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()) == nullptr || !Bounds.IsValid)
+	{
+		return;
+	}
+
+	Field.Build = MakeShareable(new FFlowFieldBuild());
+	FFlowFieldBuild& Build = *Field.Build;
+	Build.GoalLocation = Goal->GetActorLocation();
+	Build.Origin = FVector2D(Bounds.Min.X, Bounds.Min.Y);
+	Build.Size.X = FMath::Clamp(FMath::CeilToInt((Bounds.Max.X - Bounds.Min.X) / CellSize), 1, MaxCellsPerAxis);
+	Build.Size.Y = FMath::Clamp(FMath::CeilToInt((Bounds.Max.Y - Bounds.Min.Y) / CellSize), 1, MaxCellsPerAxis);
+
+	const int32 NumCells = Build.Size.X * Build.Size.Y;
+	Build.NextStep.Init(Unreachable, NumCells);
+	Build.CellHeight.Init(0.0f, NumCells);
+	Build.Walkable.Init(false, NumCells);
+	Build.NextProjectedCell = 0;
+	Build.bSearching = false;
+}
+
+bool UStrategyFlowFieldSubsystem::StepBuild(FFlowFieldBuild& Build, double EndTime) const
+{
+	using namespace StrategyFlowField;
+	typedef FFlowFieldBuild::FOpenCell FOpenCell;
+
+	UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSys == nullptr)
+	{
+		return true;
+	}
+
+	const int32 NumCells = Build.Size.X * Build.Size.Y;
+	int32 NumQueries = 0;
+	auto IsOutOfTime = [&NumQueries, EndTime]()
+	{
+		return EndTime > 0.0 && (++NumQueries % QueriesPerTimeCheck) == 0 && FPlatformTime::Seconds() >= EndTime;
+	};
+
+	// find navigable cells
+	if (!Build.bSearching)
+	{
+		const FBox Bounds = GetFieldBounds();
+		const FVector ProjectExtent(CellSize * 0.5f, CellSize * 0.5f, Bounds.GetExtent().Z + 500.0f);
+		const float CenterZ = Bounds.GetCenter().Z;
+		while (Build.NextProjectedCell < NumCells)
+		{
+			const int32 CellIdx = Build.NextProjectedCell++;
+			const FVector CellCenter(Build.Origin.X + (CellIdx % Build.Size.X + 0.5f) * CellSize, Build.Origin.Y + (CellIdx / Build.Size.X + 0.5f) * CellSize, CenterZ);
+			FNavLocation NavLocation;
+			if (NavSys->ProjectPointToNavigation(CellCenter, NavLocation, ProjectExtent))
+			{
+				Build.Walkable[CellIdx] = true;
+				Build.CellHeight[CellIdx] = NavLocation.Location.Z;
+			}
+
+			if (IsOutOfTime())
+			{
+				return false;
+			}
+		}
+
+		// goal itself is usually not navigable, start from closest navigable point
+		FNavLocation NavGoal;
+		if (!NavSys->ProjectPointToNavigation(Build.GoalLocation, NavGoal, FVector(1000.0f, 1000.0f, 1000.0f)))
+		{
+			return true;
+		}
+
+		const FIntPoint GoalCoords(FMath::FloorToInt((NavGoal.Location.X - Build.Origin.X) / CellSize), FMath::FloorToInt((NavGoal.Location.Y - Build.Origin.Y) / CellSize));
+		if (GoalCoords.X < 0 || GoalCoords.Y < 0 || GoalCoords.X >= Build.Size.X || GoalCoords.Y >= Build.Size.Y)
+		{
+			return true;
+		}
+
+		const int32 GoalIdx = GoalCoords.Y * Build.Size.X + GoalCoords.X;
+		Build.Walkable[GoalIdx] = true;
+		Build.CellHeight[GoalIdx] = NavGoal.Location.Z;
+		Build.NextStep[GoalIdx] = GoalCell;
+
+		Build.Cost.Init(MAX_uint32, NumCells);
+		Build.Cost[GoalIdx] = 0;
+		Build.Open.HeapPush(FOpenCell(0, GoalIdx));
+		Build.bSearching = true;
+	}
+
+	// dijkstra from goal, every reached cell points back to cell it was reached from
+	while (Build.Open.Num() > 0)
+	{
+		FOpenCell Current(0, 0);
+		Build.Open.HeapPop(Current, false);
+		if (Current.Cost > Build.Cost[Current.Index])
+		{
+			continue;
+		}
+
+		const FIntPoint CurrentCell(Current.Index % Build.Size.X, Current.Index / Build.Size.X);
+		const FVector CurrentLocation(Build.Origin.X + (CurrentCell.X + 0.5f) * CellSize, Build.Origin.Y + (CurrentCell.Y + 0.5f) * CellSize, Build.CellHeight[Current.Index]);
+
+		for (int32 Dir = 0; Dir < 8; Dir++)
+		{
+			const FIntPoint TestCell = CurrentCell + NeighbourOffsets[Dir];
+			if (TestCell.X < 0 || TestCell.Y < 0 || TestCell.X >= Build.Size.X || TestCell.Y >= Build.Size.Y)
+			{
+				continue;
+			}
+
+			const int32 TestIdx = TestCell.Y * Build.Size.X + TestCell.X;
+			const uint32 TestCost = Current.Cost + StepCost[Dir];
+			if (!Build.Walkable[TestIdx] || TestCost >= Build.Cost[TestIdx] || FMath::Abs(Build.CellHeight[TestIdx] - Build.CellHeight[Current.Index]) > MaxStepHeight)
+			{
+				continue;
+			}
+
+			// don't cut corners
+			if (Dir >= 4 && (!Build.Walkable[CurrentCell.Y * Build.Size.X + TestCell.X] || !Build.Walkable[TestCell.Y * Build.Size.X + CurrentCell.X]))
+			{
+				continue;
+			}
+
+			const FVector TestLocation(Build.Origin.X + (TestCell.X + 0.5f) * CellSize, Build.Origin.Y + (TestCell.Y + 0.5f) * CellSize, Build.CellHeight[TestIdx]);
+			FVector HitLocation;
+			if (UNavigationSystemV1::NavigationRaycast(GetWorld(), TestLocation, CurrentLocation, HitLocation))
+			{
+				continue;
+			}
+
+			Build.Cost[TestIdx] = TestCost;
+			Build.NextStep[TestIdx] = Opposite[Dir];
+			Build.Open.HeapPush(FOpenCell(TestCost, TestIdx));
+		}
+
+		// cell is fully expanded, safe point to yield
+		if (IsOutOfTime())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool UStrategyFlowFieldSubsystem::GetFlowDirection(const AActor* Goal, const FVector& Location, FVector& OutDirection)
+{
+	using namespace StrategyFlowField;
+	SCOPE_CYCLE_COUNTER(STAT_StrategyFlowFieldQuery);
+
+	if (Goal == nullptr)
+	{
+		return false;
+	}
+
+	// field is built in following frames, until then callers use regular pathfinding
+	FFlowField* Field = Fields.Find(Goal);
+	if (Field == nullptr)
+	{
+		Field = &Fields.Add(Goal);
+		Field->Size = FIntPoint::ZeroValue;
+		Field->bDirty = true;
+		return false;
+	}
+
+	if (!Field->bDirty && !Field->Build.IsValid() && Field->Size != FIntPoint::ZeroValue && !Field->GoalLocation.Equals(Goal->GetActorLocation()))
+	{
+		Field->bDirty = true;
+	}
+
+	FIntPoint Cell(FMath::FloorToInt((Location.X - Field->Origin.X) / CellSize), FMath::FloorToInt((Location.Y - Field->Origin.Y) / CellSize));
+	if (Cell.X < 0 || Cell.Y < 0 || Cell.X >= Field->Size.X || Cell.Y >= Field->Size.Y)
+	{
+		return false;
+	}
+
+	uint8 Step = Field->NextStep[Cell.Y * Field->Size.X + Cell.X];
+	if (Step == Unreachable)
+	{
+		return false;
+	}
+
+	// look two cells ahead for smoother movement
+	FVector2D Target(Field->GoalLocation.X, Field->GoalLocation.Y);
+	for (int32 LookAhead = 0; LookAhead < 2 && Step != GoalCell; LookAhead++)
+	{
+		Cell += NeighbourOffsets[Step];
+		Target = Field->Origin + FVector2D((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize);
+		Step = Field->NextStep[Cell.Y * Field->Size.X + Cell.X];
+	}
+
+	OutDirection = FVector(Target.X - Location.X, Target.Y - Location.Y, 0.0f).GetSafeNormal();
+	return !OutDirection.IsNearlyZero();
+}
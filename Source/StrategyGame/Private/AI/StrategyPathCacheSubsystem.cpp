@@ -0,0 +1,147 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyPathCacheSubsystem.h"
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshPath.h"
+#include "AIController.h"
+
+DECLARE_CYCLE_STAT(TEXT("Path cache lookup"), STAT_StrategyPathCacheLookup, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path cache hits"), STAT_StrategyPathCacheHits, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path cache misses"), STAT_StrategyPathCacheMisses, STATGROUP_StrategyAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path cache entries"), STAT_StrategyPathCacheEntries, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarPathCacheEnabled(TEXT("Strategy.AI.PathCache"), 1, TEXT("If set, AI moves reuse cached paths found for the same start and goal navmesh polygons."));
+
+UStrategyPathCacheSubsystem::UStrategyPathCacheSubsystem()
+	: MaxPathAge(10.0f), MaxCachedPaths(256)
+{
+}
+
+void UStrategyPathCacheSubsystem::Deinitialize()
+{
+	Flush();
+	Super::Deinitialize();
+}
+
+bool UStrategyPathCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStrategyPathCacheSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld);
+	if (NavSys != nullptr)
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &UStrategyPathCacheSubsystem::OnNavigationGenerationFinished);
+	}
+}
+
+bool UStrategyPathCacheSubsystem::IsEnabled()
+{
+	return CVarPathCacheEnabled.GetValueOnGameThread() != 0;
+}
+
+void UStrategyPathCacheSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	Flush();
+}
+
+void UStrategyPathCacheSubsystem::Flush()
+{
+	CachedPaths.Reset();
+	SET_DWORD_STAT(STAT_StrategyPathCacheEntries, 0);
+}
+
+bool UStrategyPathCacheSubsystem::FindPath(const AAIController* Querier, const FAIMoveRequest& MoveRequest, FStrategyPathCacheKey& OutKey, FNavPathSharedPtr& OutPath)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyPathCacheLookup);
+
+	OutKey = FStrategyPathCacheKey();
+	const APawn* const MyPawn = Querier != nullptr ? Querier->GetPawn() : nullptr;
+	UNavigationSystemV1* const NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (MyPawn == nullptr || NavSys == nullptr || !MoveRequest.IsValid() || !MoveRequest.IsUsingPathfinding())
+	{
+		return false;
+	}
+
+	const FNavAgentProperties& AgentProps = Querier->GetNavAgentPropertiesRef();
+	const FVector GoalLocation = MoveRequest.GetDestination();
+
+	FNavLocation StartLocation;
+	FNavLocation GoalNavLocation;
+	if (!NavSys->ProjectPointToNavigation(MyPawn->GetNavAgentLocation(), StartLocation, INVALID_NAVEXTENT, &AgentProps) ||
+		!NavSys->ProjectPointToNavigation(GoalLocation, GoalNavLocation, INVALID_NAVEXTENT, &AgentProps))
+	{
+		return false;
+	}
+
+	OutKey.StartPoly = StartLocation.NodeRef;
+	OutKey.GoalPoly  = GoalNavLocation.NodeRef;
+	OutKey.GoalActor = MoveRequest.IsMoveToActorRequest() ? MoveRequest.GetGoalActor() : nullptr;
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const FCachedPath* const Entry = CachedPaths.Find(OutKey);
+	if (Entry == nullptr || !Entry->NavData.IsValid() || (CurrentTime - Entry->CreationTime) > MaxPathAge)
+	{
+		if (Entry != nullptr)
+		{
+			CachedPaths.Remove(OutKey);
+		}
+
+		INC_DWORD_STAT(STAT_StrategyPathCacheMisses);
+		return false;
+	}
+
+	// start and goal are in the same polygons as cached path's ends, so the corridor still connects them;
+	// moved ends can change which corners path goes around, points are string pulled again from the new ends
+	TSharedPtr<FNavMeshPath> NewPath = MakeShareable(new FNavMeshPath());
+	NewPath->SetNavigationDataUsed(Entry->NavData.Get());
+	NewPath->SetQuerier(Querier);
+	NewPath->SetTimeStamp(CurrentTime);
+	NewPath->PathCorridor = Entry->PathCorridor;
+	NewPath->PathCorridorCost = Entry->PathCorridorCost;
+	NewPath->PerformStringPulling(StartLocation.Location, GoalNavLocation.Location);
+	if (!NewPath->IsStringPulled() || NewPath->GetPathPoints().Num() < 2)
+	{
+		CachedPaths.Remove(OutKey);
+		INC_DWORD_STAT(STAT_StrategyPathCacheMisses);
+		return false;
+	}
+	NewPath->MarkReady();
+
+	if (MoveRequest.IsMoveToActorRequest())
+	{
+		NewPath->SetGoalActorObservation(*MoveRequest.GetGoalActor(), 100.0f);
+	}
+	NewPath->EnableRecalculationOnInvalidation(true);
+
+	OutPath = NewPath;
+	INC_DWORD_STAT(STAT_StrategyPathCacheHits);
+	return true;
+}
+
+void UStrategyPathCacheSubsystem::AddPath(const FStrategyPathCacheKey& Key, FNavPathSharedPtr Path)
+{
+	const FNavMeshPath* const NavMeshPath = Path.IsValid() ? Path->CastPath<FNavMeshPath>() : nullptr;
+	if (!Key.IsValid() || NavMeshPath == nullptr || !Path->IsValid() || Path->IsPartial() || Path->GetNavigationDataUsed() == nullptr || NavMeshPath->PathCorridor.Num() == 0)
+	{
+		return;
+	}
+
+	if (CachedPaths.Num() >= MaxCachedPaths)
+	{
+		Flush();
+	}
+
+	FCachedPath& Entry = CachedPaths.FindOrAdd(Key);
+	Entry.PathCorridor = NavMeshPath->PathCorridor;
+	Entry.PathCorridorCost = NavMeshPath->PathCorridorCost;
+	Entry.NavData = Path->GetNavigationDataUsed();
+	Entry.CreationTime = GetWorld()->GetTimeSeconds();
+
+	SET_DWORD_STAT(STAT_StrategyPathCacheEntries, CachedPaths.Num());
+}
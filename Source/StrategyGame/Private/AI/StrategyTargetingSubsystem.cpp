@@ -0,0 +1,332 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyTargetingSubsystem.h"
+#include "StrategyAIController.h"
+#include "StrategyAISensingComponent.h"
+#include "StrategySpatialGrid.h"
+#include "VisualLogger/VisualLogger.h"
+
+DECLARE_CYCLE_STAT(TEXT("Target selection"), STAT_StrategyTargetSelection, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target selections"), STAT_StrategyTargetSelections, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target candidates scored"), STAT_StrategyTargetCandidates, STATGROUP_StrategyAI);
+
+UStrategyTargetingSubsystem::UStrategyTargetingSubsystem()
+{
+}
+
+void UStrategyTargetingSubsystem::Deinitialize()
+{
+	Controllers.Reset();
+	AttackerToTarget.Reset();
+	TargetClaimCount.Reset();
+	ExtraClaims.Reset();
+	FreeSlots.Reset();
+	CharToController.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UStrategyTargetingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UStrategyTargetingSubsystem::GetSlot(const AStrategyAIController* InController) const
+{
+	if (InController != nullptr && Controllers.IsValidIndex(InController->TargetingSlot) && Controllers[InController->TargetingSlot] == InController)
+	{
+		return InController->TargetingSlot;
+	}
+
+	return INDEX_NONE;
+}
+
+int32 UStrategyTargetingSubsystem::GetCharSlot(const AStrategyChar* InChar, const FStrategyGridHandle& Handle)
+{
+	if (CharToController.IsValidIndex(Handle.Slot))
+	{
+		const FCharSlot& CachedSlot = CharToController[Handle.Slot];
+		if (CachedSlot.bValid && CachedSlot.Serial == Handle.Serial)
+		{
+			return CachedSlot.ControllerSlot;
+		}
+	}
+
+	// first lookup since character entered grid or its controller changed
+	const int32 Slot = GetSlot(Cast<AStrategyAIController>(InChar->GetController()));
+	if (Handle.Slot != INDEX_NONE)
+	{
+		if (!CharToController.IsValidIndex(Handle.Slot))
+		{
+			CharToController.SetNumZeroed(Handle.Slot + 1);
+		}
+
+		FCharSlot& CachedSlot = CharToController[Handle.Slot];
+		CachedSlot.Serial = Handle.Serial;
+		CachedSlot.ControllerSlot = Slot;
+		CachedSlot.bValid = true;
+	}
+
+	return Slot;
+}
+
+void UStrategyTargetingSubsystem::ResetCharSlot(const AStrategyAIController* InController)
+{
+	const UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	const FStrategyGridHandle Handle = Grid != nullptr ? Grid->GetHandle(Cast<AStrategyChar>(InController->GetPawn())) : FStrategyGridHandle();
+	if (CharToController.IsValidIndex(Handle.Slot))
+	{
+		CharToController[Handle.Slot].bValid = false;
+	}
+}
+
+void UStrategyTargetingSubsystem::RegisterController(AStrategyAIController* InController)
+{
+	if (InController == nullptr || GetSlot(InController) != INDEX_NONE)
+	{
+		return;
+	}
+
+	int32 Slot = INDEX_NONE;
+	if (FreeSlots.Num() > 0)
+	{
+		Slot = FreeSlots.Pop(false);
+		Controllers[Slot] = InController;
+	}
+	else
+	{
+		Slot = Controllers.Add(InController);
+		AttackerToTarget.Add(INDEX_NONE);
+		TargetClaimCount.Add(0);
+	}
+
+	AttackerToTarget[Slot] = INDEX_NONE;
+	TargetClaimCount[Slot] = 0;
+	InController->TargetingSlot = Slot;
+	ResetCharSlot(InController);
+}
+
+void UStrategyTargetingSubsystem::UnregisterController(AStrategyAIController* InController)
+{
+	const int32 Slot = GetSlot(InController);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	// unpossessed controller releases claim on its current target, other claims it left behind are still counted
+	const AStrategyChar* const CurrentChar = Cast<AStrategyChar>(InController->CurrentTarget);
+	const UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (CurrentChar != nullptr)
+	{
+		const int32 CurrentTargetSlot = GetCharSlot(CurrentChar, Grid != nullptr ? Grid->GetHandle(CurrentChar) : FStrategyGridHandle());
+		if (CurrentTargetSlot != INDEX_NONE)
+		{
+			RemoveClaim(Slot, CurrentTargetSlot);
+		}
+	}
+
+	// nobody can hold claims of free slot or on it
+	AttackerToTarget[Slot] = INDEX_NONE;
+	for (int32 Idx = 0; TargetClaimCount[Slot] > 0 && Idx < AttackerToTarget.Num(); Idx++)
+	{
+		if (AttackerToTarget[Idx] == Slot)
+		{
+			AttackerToTarget[Idx] = INDEX_NONE;
+		}
+	}
+	for (int32 Idx = ExtraClaims.Num() - 1; Idx >= 0; Idx--)
+	{
+		if (ExtraClaims[Idx].X == Slot || ExtraClaims[Idx].Y == Slot)
+		{
+			ExtraClaims.RemoveAtSwap(Idx, 1, false);
+		}
+	}
+	TargetClaimCount[Slot] = 0;
+
+	ResetCharSlot(InController);
+	Controllers[Slot] = nullptr;
+	FreeSlots.Add(Slot);
+	InController->TargetingSlot = INDEX_NONE;
+}
+
+bool UStrategyTargetingSubsystem::HasClaim(int32 AttackerSlot, int32 TargetSlot) const
+{
+	return AttackerToTarget[AttackerSlot] == TargetSlot || (ExtraClaims.Num() > 0 && ExtraClaims.Contains(FIntPoint(AttackerSlot, TargetSlot)));
+}
+
+void UStrategyTargetingSubsystem::AddClaim(int32 AttackerSlot, int32 TargetSlot)
+{
+	if (HasClaim(AttackerSlot, TargetSlot))
+	{
+		return;
+	}
+
+	// attacker can be holding claim it never released, it's still counted
+	if (AttackerToTarget[AttackerSlot] != INDEX_NONE)
+	{
+		ExtraClaims.Add(FIntPoint(AttackerSlot, AttackerToTarget[AttackerSlot]));
+	}
+
+	AttackerToTarget[AttackerSlot] = TargetSlot;
+	TargetClaimCount[TargetSlot]++;
+}
+
+void UStrategyTargetingSubsystem::RemoveClaim(int32 AttackerSlot, int32 TargetSlot)
+{
+	if (AttackerToTarget[AttackerSlot] == TargetSlot)
+	{
+		AttackerToTarget[AttackerSlot] = INDEX_NONE;
+		TargetClaimCount[TargetSlot]--;
+	}
+	else if (ExtraClaims.Num() > 0 && ExtraClaims.RemoveSingleSwap(FIntPoint(AttackerSlot, TargetSlot), false) > 0)
+	{
+		TargetClaimCount[TargetSlot]--;
+	}
+}
+
+void UStrategyTargetingSubsystem::ClaimTarget(const AStrategyAIController* Attacker, const AStrategyAIController* Target)
+{
+	const int32 AttackerSlot = GetSlot(Attacker);
+	const int32 TargetSlot = GetSlot(Target);
+	if (AttackerSlot != INDEX_NONE && TargetSlot != INDEX_NONE)
+	{
+		AddClaim(AttackerSlot, TargetSlot);
+	}
+}
+
+void UStrategyTargetingSubsystem::UnClaimTarget(const AStrategyAIController* Attacker, const AStrategyAIController* Target)
+{
+	const int32 AttackerSlot = GetSlot(Attacker);
+	const int32 TargetSlot = GetSlot(Target);
+	if (AttackerSlot != INDEX_NONE && TargetSlot != INDEX_NONE)
+	{
+		RemoveClaim(AttackerSlot, TargetSlot);
+	}
+}
+
+bool UStrategyTargetingSubsystem::IsClaimedBy(const AStrategyAIController* Target, const AStrategyAIController* Attacker) const
+{
+	const int32 AttackerSlot = GetSlot(Attacker);
+	const int32 TargetSlot = GetSlot(Target);
+	return AttackerSlot != INDEX_NONE && TargetSlot != INDEX_NONE && HasClaim(AttackerSlot, TargetSlot);
+}
+
+int32 UStrategyTargetingSubsystem::GetNumberOfAttackers(const AStrategyAIController* Target) const
+{
+	const int32 TargetSlot = GetSlot(Target);
+	return TargetSlot != INDEX_NONE ? TargetClaimCount[TargetSlot] : 0;
+}
+
+float UStrategyTargetingSubsystem::ScoreTarget(float DistSq, bool bIsCurrentTarget, bool bHasAIController, bool bClaimedByMe, int32 NumAttackers)
+{
+	float TargetScore = DistSq;
+	if (bIsCurrentTarget)
+	{
+		TargetScore -= FMath::Square(300.0f);
+	}
+
+	if (bHasAIController)
+	{
+		if (bClaimedByMe)
+		{
+			TargetScore -= FMath::Square(300.0f);
+		}
+		else
+		{
+			TargetScore += NumAttackers * FMath::Square(900.0f);
+		}
+	}
+
+	return TargetScore;
+}
+
+int32 UStrategyTargetingSubsystem::PickTarget(const FVector& PawnLocation, TArrayView<const FStrategyTargetCandidate> Candidates, TArrayView<const int32> ClaimCounts)
+{
+	float BestUnitScore = 10000;
+	int32 BestIndex = INDEX_NONE;
+
+	for (int32 Idx = 0; Idx < Candidates.Num(); Idx++)
+	{
+		const FStrategyTargetCandidate& Candidate = Candidates[Idx];
+		const bool bHasAIController = Candidate.ControllerSlot != INDEX_NONE;
+		const float TargetScore = ScoreTarget((PawnLocation - Candidate.Location).SizeSquared(), Candidate.bIsCurrentTarget,
+			bHasAIController, Candidate.bClaimedByMe, bHasAIController ? ClaimCounts[Candidate.ControllerSlot] : 0);
+
+		if (BestIndex == INDEX_NONE || BestUnitScore > TargetScore)
+		{
+			BestUnitScore = TargetScore;
+			BestIndex = Idx;
+		}
+	}
+
+	return BestIndex;
+}
+
+void UStrategyTargetingSubsystem::SelectTarget(AStrategyAIController* InController)
+{
+	const int32 Slot = GetSlot(InController);
+	const APawn* const MyPawn = Slot != INDEX_NONE ? InController->GetPawn() : nullptr;
+	if (MyPawn == nullptr)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_StrategyTargetSelection);
+
+	const UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	const FStrategyKnownTargets& KnownTargets = InController->GetSensingComponent()->KnownTargets;
+	TArray<FStrategyTargetCandidate, TInlineAllocator<32>> Candidates;
+	TArray<AStrategyChar*, TInlineAllocator<32>> CandidateChars;
+
+	for (int32 Idx = 0; Idx < KnownTargets.Num(); Idx++)
+	{
+		AStrategyChar* const TestChar = KnownTargets.GetTarget(Idx);
+		if (TestChar == nullptr || !InController->IsTargetValid(TestChar))
+		{
+			continue;
+		}
+
+		/** don't care about targets with disabled logic */
+		const int32 TargetSlot = GetCharSlot(TestChar, KnownTargets.GetHandle(Idx));
+		if (TargetSlot != INDEX_NONE && !Controllers[TargetSlot]->IsLogicEnabled())
+		{
+			continue;
+		}
+
+		FStrategyTargetCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+		Candidate.Location = TestChar->GetActorLocation();
+		Candidate.ControllerSlot = TargetSlot;
+		Candidate.bIsCurrentTarget = InController->CurrentTarget == TestChar;
+		Candidate.bClaimedByMe = TargetSlot != INDEX_NONE && HasClaim(Slot, TargetSlot);
+		CandidateChars.Add(TestChar);
+	}
+
+	const int32 BestIndex = PickTarget(MyPawn->GetActorLocation(), Candidates, TargetClaimCount);
+	AActor* const BestUnit = BestIndex != INDEX_NONE ? CandidateChars[BestIndex] : nullptr;
+	const int32 BestUnitSlot = BestIndex != INDEX_NONE ? Candidates[BestIndex].ControllerSlot : INDEX_NONE;
+
+	INC_DWORD_STAT(STAT_StrategyTargetSelections);
+	INC_DWORD_STAT_BY(STAT_StrategyTargetCandidates, KnownTargets.Num());
+
+	// losing all targets keeps the claim, switching releases claim on previous target
+	const AActor* OldTarget = InController->CurrentTarget;
+	InController->CurrentTarget = BestUnit;
+	if (BestUnit != nullptr && OldTarget != BestUnit)
+	{
+		const AStrategyChar* const OldTargetChar = Cast<const AStrategyChar>(OldTarget);
+		const int32 OldTargetSlot = OldTargetChar != nullptr ? GetCharSlot(OldTargetChar, Grid != nullptr ? Grid->GetHandle(OldTargetChar) : FStrategyGridHandle()) : INDEX_NONE;
+		if (OldTargetSlot != INDEX_NONE)
+		{
+			RemoveClaim(Slot, OldTargetSlot);
+		}
+
+		if (BestUnitSlot != INDEX_NONE)
+		{
+			AddClaim(Slot, BestUnitSlot);
+		}
+	}
+
+	UE_VLOG(InController, LogStrategyAI, Log, TEXT("Selected target: %s"), BestUnit != nullptr ? *BestUnit->GetName() : TEXT("NONE"));
+}
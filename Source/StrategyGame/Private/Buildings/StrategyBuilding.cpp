@@ -6,10 +6,18 @@
 #include "SStrategySlateHUDWidget.h"
 #include "SStrategyButtonWidget.h"
 #include "StrategySelectionInterface.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "StrategySimProfiler.h"
+#include "StrategyActorPoolSubsystem.h"
+#include "StrategyTowerTargetingSubsystem.h"
+#include "StrategyProjectile.h"
+#include "StrategyGameBlueprintLibrary.h"
 
 AStrategyBuilding::AStrategyBuilding(const FObjectInitializer& ObjectInitializer) 
 	: Super(ObjectInitializer), Cost(0), BuildTime(10), BuildingName(TEXT("Unknown")), Health(100), bAffectFriendlyMinion(true), 
-    bAffectEnemyMinion(true), bIsContructionFinished(false), bIsBeingBuild(false), bIsActionMenuDisplayed(false), MyTeamNum(EStrategyTeam::Unknown), RemainingBuildTime(0)
+    bAffectEnemyMinion(true), bIsContructionFinished(false), bIsBeingBuild(false), bIsActionMenuDisplayed(false), MyTeamNum(EStrategyTeam::Unknown), RemainingBuildTime(0),
+    ProjectilePoolPrewarmSize(8), bProjectilePoolPrewarmed(false), TowerFireInterval(1.0f), TowerImpactDamage(10), TowerProjectileLifeSpan(5.0f),
+    TowerMuzzleOffset(0, 0, 300), TowerTargeting(EStrategyTowerTargeting::Nearest), TowerIndex(INDEX_NONE)
 {
 	SetCanBeDamaged(false);
 
@@ -57,6 +65,28 @@ void AStrategyBuilding::PostInitializeComponents()
 	}
 }
 
+void AStrategyBuilding::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// buildings placed in level can start finished
+	if (bIsContructionFinished)
+	{
+		RegisterTower();
+	}
+}
+
+void AStrategyBuilding::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UStrategyTowerTargetingSubsystem* const TowerTargeting = GetWorld()->GetSubsystem<UStrategyTowerTargetingSubsystem>();
+	if (TowerTargeting != nullptr)
+	{
+		TowerTargeting->UnregisterTower(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AStrategyBuilding::Destroyed()
 {
 	FPlayerData* const PlayerData = GetTeamData();
@@ -65,6 +95,19 @@ void AStrategyBuilding::Destroyed()
 		PlayerData->BuildingsList.Remove(this);
 	}
 
+	AStrategyGameState* const MyGameState = GetWorld() ? GetWorld()->GetGameState<AStrategyGameState>() : nullptr;
+	if (MyGameState != nullptr)
+	{
+		MyGameState->RemoveUnfinishedBuilding(this);
+	}
+
+	UStrategyTeamRegistry* const TeamRegistry = GetWorld() ? GetWorld()->GetSubsystem<UStrategyTeamRegistry>() : nullptr;
+	if (TeamRegistry != nullptr)
+	{
+		TeamRegistry->RemoveActor(this);
+	}
+
+	InvalidateFlowFields();
 	Super::Destroyed();
 }
 
@@ -133,7 +176,7 @@ void AStrategyBuilding::NotifyActorBeginOverlap(AActor* Other)
 	Super::NotifyActorBeginOverlap(Other);
 
 	AStrategyChar* const OtherChar = Cast<AStrategyChar>(Other);
-	if (bIsContructionFinished && CanAffectChar(OtherChar))
+	if (bIsContructionFinished && CanAffectChar(OtherChar) && !IsNativeTower())
 	{
 		OnCharTouch(OtherChar);
 	}
@@ -148,10 +191,23 @@ bool AStrategyBuilding::CanAffectChar(AStrategyChar const* InChar) const
 void AStrategyBuilding::SetTeamNum(uint8 NewTeamNum)
 {
 	MyTeamNum = NewTeamNum;
-	FPlayerData* const PlayerData = GetTeamData();
+
+	UStrategyTeamRegistry* const TeamRegistry = GetWorld() ? GetWorld()->GetSubsystem<UStrategyTeamRegistry>() : nullptr;
+	if (TeamRegistry != nullptr)
+	{
+		TeamRegistry->SetTeam(this, MyTeamNum);
+	}
+
+	FPlayerData* const PlayerData = GetWorld() ? GetTeamData() : nullptr;
 	if (PlayerData != nullptr)
 	{
 		PlayerData->BuildingsList.Add(this);
+
+		AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+		if (!bIsContructionFinished)
+		{
+			MyGameState->AddUnfinishedBuilding(this);
+		}
 	}
 }
 
@@ -171,7 +227,7 @@ void AStrategyBuilding::ShowActionMenu()
 	if (!bIsActionMenuDisplayed && !bIsCustomActionDisplayed)
 	{
 		UWorld* const World = GetWorld();
-		const APlayerController* MyOwner = (MyTeamNum == EStrategyTeam::Player) ? GEngine->GetFirstLocalPlayerController(World) : nullptr;
+		const APlayerController* MyOwner = (MyTeamNum == EStrategyTeam::Player) ? World->GetFirstPlayerController() : nullptr;
 		AStrategyHUD* const MyHUD = (MyOwner) ? Cast<AStrategyHUD>(MyOwner->GetHUD()) : nullptr;
 		if (MyHUD)
 		{
@@ -223,7 +279,7 @@ void AStrategyBuilding::HideActionMenu()
 		bIsActionMenuDisplayed   = false;
 		bIsCustomActionDisplayed = false;
 
-		const APlayerController* MyOwner = (MyTeamNum == EStrategyTeam::Player) ? GEngine->GetFirstLocalPlayerController(GetWorld()) : nullptr;
+		const APlayerController* MyOwner = (MyTeamNum == EStrategyTeam::Player) ? GetWorld()->GetFirstPlayerController() : nullptr;
 		AStrategyHUD* const MyHUD = (MyOwner) ? Cast<AStrategyHUD>(MyOwner->GetHUD()) : nullptr;
 		if (MyHUD)
 		{
@@ -235,7 +291,6 @@ void AStrategyBuilding::HideActionMenu()
 int32 AStrategyBuilding::GetBuildingCost(UWorld *World) const
 {
 	int32 BuildingsCounter = 0;
-	const APlayerController* MyOwner = GEngine->GetFirstLocalPlayerController(World);
 	FPlayerData* const PlayerData = World ? World->GetGameState<AStrategyGameState>()->GetPlayerData(EStrategyTeam::Player) : nullptr;
 	if (PlayerData != nullptr)
 	{
@@ -308,6 +363,7 @@ bool AStrategyBuilding::StartBuild()
 		bIsBeingBuild = true;
 		InitialBuildTime = RemainingBuildTime = GetBuildTime();
 		OnBuildStarted();
+		InvalidateFlowFields();
 
 		SetActorTickEnabled(true);
 		if (ConstructionStartStinger)
@@ -322,6 +378,7 @@ bool AStrategyBuilding::StartBuild()
 
 void AStrategyBuilding::Tick(float DeltaTime)
 {
+	STRATEGY_SIM_PROFILE_SCOPE(GetWorld(), EStrategySimStat::Buildings);
 	Super::Tick(DeltaTime);
 
 	if (!bIsBeingBuild || bIsContructionFinished)
@@ -353,8 +410,77 @@ void AStrategyBuilding::FinishBuild()
 		{
 			UGameplayStatics::PlaySoundAtLocation(this, ConstructionEndStinger, GetActorLocation());
 		}
+		AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+		if (MyGameState != nullptr)
+		{
+			MyGameState->RemoveUnfinishedBuilding(this);
+		}
+
 		OnBuildFinished();
 		BuildFinishedDelegate.ExecuteIfBound(this);
+		RegisterTower();
+		InvalidateFlowFields();
+	}
+}
+
+void AStrategyBuilding::PrewarmProjectilePool(UClass* InProjectileClass)
+{
+	if (bProjectilePoolPrewarmed || InProjectileClass == nullptr)
+	{
+		return;
+	}
+
+	bProjectilePoolPrewarmed = true;
+	UStrategyActorPoolSubsystem* const Pool = GetWorld()->GetSubsystem<UStrategyActorPoolSubsystem>();
+	if (Pool != nullptr && ProjectilePoolPrewarmSize > 0)
+	{
+		Pool->Prewarm(InProjectileClass, Pool->GetNumPooled(InProjectileClass) + ProjectilePoolPrewarmSize);
+	}
+}
+
+bool AStrategyBuilding::IsNativeTower() const
+{
+	return TowerProjectileClass != nullptr && UStrategyTowerTargetingSubsystem::IsEnabled();
+}
+
+void AStrategyBuilding::RegisterTower()
+{
+	UStrategyTowerTargetingSubsystem* const TowerTargeting = GetWorld()->GetSubsystem<UStrategyTowerTargetingSubsystem>();
+	if (TowerTargeting != nullptr && TowerProjectileClass != nullptr && MyTeamNum > EStrategyTeam::Unknown)
+	{
+		TowerTargeting->RegisterTower(this);
+	}
+}
+
+void AStrategyBuilding::FireAtTarget(AStrategyChar* Target)
+{
+	if (Target == nullptr || TowerProjectileClass == nullptr)
+	{
+		return;
+	}
+
+	// aim where target will be when projectile gets there
+	const FVector MuzzleLocation = GetActorTransform().TransformPosition(TowerMuzzleOffset);
+	const float ProjectileSpeed = TowerProjectileClass->GetDefaultObject<AStrategyProjectile>()->GetMovementComp()->InitialSpeed;
+	FVector AimLocation = Target->GetActorLocation();
+	if (ProjectileSpeed > 0.0f)
+	{
+		AimLocation += Target->GetVelocity() * (FVector::Dist(MuzzleLocation, AimLocation) / ProjectileSpeed);
+	}
+
+	const FVector ShootDirection = (AimLocation - MuzzleLocation).GetSafeNormal();
+	AStrategyProjectile* const Projectile = UStrategyGameBlueprintLibrary::SpawnProjectileFromClass(this, TowerProjectileClass, MuzzleLocation, ShootDirection,
+		(EStrategyTeam::Type)MyTeamNum, TowerImpactDamage, TowerProjectileLifeSpan, this);
+	OnTowerFire(Target, Projectile);
+}
+
+void AStrategyBuilding::InvalidateFlowFields()
+{
+	UWorld* const World = GetWorld();
+	UStrategyFlowFieldSubsystem* const FlowFields = World != nullptr ? World->GetSubsystem<UStrategyFlowFieldSubsystem>() : nullptr;
+	if (FlowFields != nullptr)
+	{
+		FlowFields->InvalidateFields();
 	}
 }
 
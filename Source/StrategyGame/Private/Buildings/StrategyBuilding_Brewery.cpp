@@ -128,7 +128,7 @@ void AStrategyBuilding_Brewery::ShowActionMenu()
 	Super::ShowActionMenu();
 	if (bIsActionMenuDisplayed)
 	{
-		const APlayerController* MyOwner = (MyTeamNum == EStrategyTeam::Player) ? GEngine->GetFirstLocalPlayerController(GetWorld()) : NULL;
+		const APlayerController* MyOwner = (MyTeamNum == EStrategyTeam::Player) ? GetWorld()->GetFirstPlayerController() : NULL;
 		AStrategyHUD* const MyHUD = (MyOwner) ? Cast<AStrategyHUD>(MyOwner->GetHUD()) : NULL;
 		if (MyHUD)
 		{
@@ -0,0 +1,201 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyTowerTargetingSubsystem.h"
+#include "StrategyBuilding.h"
+#include "StrategyBuilding_Brewery.h"
+#include "StrategySpatialGrid.h"
+#include "StrategySimProfiler.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tower target query"), STAT_StrategyTowerTargetQuery, STATGROUP_StrategyAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Towers"), STAT_StrategyTowers, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tower target queries"), STAT_StrategyTowerQueries, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tower target candidates"), STAT_StrategyTowerCandidates, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarTowerTargetingEnabled(TEXT("Strategy.Towers.NativeTargeting"), 1, TEXT("If set, towers with projectile class pick targets and fire natively, instead of through blueprint touch events."));
+
+/** trigger box is grown by this, so characters touching its edge with their capsule are in range */
+static const float MaxTargetRadius = 100.0f;
+
+UStrategyTowerTargetingSubsystem::UStrategyTowerTargetingSubsystem()
+{
+}
+
+void UStrategyTowerTargetingSubsystem::Deinitialize()
+{
+	Towers.Empty();
+	NextFireTimes.Empty();
+	RangeTransforms.Empty();
+	RangeExtents.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UStrategyTowerTargetingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyTowerTargetingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyTowerTargetingSubsystem, STATGROUP_Tickables);
+}
+
+bool UStrategyTowerTargetingSubsystem::IsEnabled()
+{
+	return CVarTowerTargetingEnabled.GetValueOnGameThread() != 0;
+}
+
+void UStrategyTowerTargetingSubsystem::RegisterTower(AStrategyBuilding* InTower)
+{
+	if (InTower == nullptr || InTower->TowerIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	// towers don't move, range is cached once
+	const UBoxComponent* const TriggerBox = InTower->GetTriggerBox();
+	InTower->TowerIndex = Towers.Add(InTower);
+	RangeTransforms.Add(FTransform(TriggerBox->GetComponentQuat(), TriggerBox->GetComponentLocation()));
+	RangeExtents.Add(TriggerBox->GetScaledBoxExtent() + FVector(MaxTargetRadius));
+
+	// spread first shots of towers finished at the same time, from match seed so replays fire the same way
+	AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+	const float FireDelay = GameState ? GameState->GetCombatRandom().FRand() : FMath::FRand();
+	NextFireTimes.Add(GetWorld()->GetTimeSeconds() + FireDelay * InTower->TowerFireInterval);
+
+	INC_DWORD_STAT(STAT_StrategyTowers);
+}
+
+void UStrategyTowerTargetingSubsystem::UnregisterTower(AStrategyBuilding* InTower)
+{
+	if (InTower == nullptr || !Towers.IsValidIndex(InTower->TowerIndex) || Towers[InTower->TowerIndex] != InTower)
+	{
+		return;
+	}
+
+	// keep arrays dense, last tower takes the free index
+	const int32 Index = InTower->TowerIndex;
+	Towers.RemoveAtSwap(Index, 1, false);
+	NextFireTimes.RemoveAtSwap(Index, 1, false);
+	RangeTransforms.RemoveAtSwap(Index, 1, false);
+	RangeExtents.RemoveAtSwap(Index, 1, false);
+	if (Towers.IsValidIndex(Index))
+	{
+		Towers[Index]->TowerIndex = Index;
+	}
+
+	InTower->TowerIndex = INDEX_NONE;
+
+	DEC_DWORD_STAT(STAT_StrategyTowers);
+}
+
+int32 UStrategyTowerTargetingSubsystem::GetNumTowers() const
+{
+	return Towers.Num();
+}
+
+void UStrategyTowerTargetingSubsystem::Tick(float DeltaTime)
+{
+	const UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Towers.Num() == 0 || Grid == nullptr || !IsEnabled())
+	{
+		return;
+	}
+
+	STRATEGY_SIM_PROFILE_SCOPE(GetWorld(), EStrategySimStat::Buildings);
+
+	// firing can spawn and destroy actors, towers ready this frame are collected first
+	const float Now = GetWorld()->GetTimeSeconds();
+	TArray<TPair<AStrategyBuilding*, AStrategyChar*>, TInlineAllocator<16>> Shots;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_StrategyTowerTargetQuery);
+		for (int32 Index = 0; Index < Towers.Num(); Index++)
+		{
+			if (NextFireTimes[Index] > Now)
+			{
+				continue;
+			}
+
+			NextFireTimes[Index] = Now + Towers[Index]->TowerFireInterval;
+			AStrategyChar* const Target = FindTarget(*Grid, Index);
+			if (Target != nullptr)
+			{
+				Shots.Add(TPair<AStrategyBuilding*, AStrategyChar*>(Towers[Index], Target));
+			}
+		}
+	}
+
+	for (const TPair<AStrategyBuilding*, AStrategyChar*>& Shot : Shots)
+	{
+		if (IsValid(Shot.Key) && IsValid(Shot.Value))
+		{
+			Shot.Key->FireAtTarget(Shot.Value);
+		}
+	}
+}
+
+AStrategyChar* UStrategyTowerTargetingSubsystem::FindTarget(const UStrategySpatialGrid& Grid, int32 Index) const
+{
+	INC_DWORD_STAT(STAT_StrategyTowerQueries);
+
+	const AStrategyBuilding* const Tower = Towers[Index];
+	const uint8 TeamNum = Tower->GetTeamNum();
+	const FTransform& RangeTransform = RangeTransforms[Index];
+	const FVector& RangeExtent = RangeExtents[Index];
+	const FVector TowerLocation = Tower->GetActorLocation();
+
+	// first in path means closest to brewery that enemies are walking to
+	EStrategyTowerTargeting::Type Policy = Tower->TowerTargeting;
+	FVector PathGoal = TowerLocation;
+	if (Policy == EStrategyTowerTargeting::FirstInPath)
+	{
+		const AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+		const FPlayerData* const TeamData = GameState ? GameState->GetPlayerData(TeamNum) : nullptr;
+		if (TeamData && TeamData->Brewery.IsValid())
+		{
+			PathGoal = TeamData->Brewery->GetActorLocation();
+		}
+		else
+		{
+			Policy = EStrategyTowerTargeting::Nearest;
+		}
+	}
+
+	AStrategyChar* BestTarget = nullptr;
+	float BestHealth = 0.0f;
+	float BestDistSq = 0.0f;
+	int32 NumCandidates = 0;
+
+	Grid.ForEachCharInRadius(RangeTransform.GetLocation(), RangeExtent.Size2D(), [&](AStrategyChar* TestChar)
+	{
+		const uint8 CharTeam = TestChar->GetTeamNum();
+		if (CharTeam <= EStrategyTeam::Unknown || CharTeam == TeamNum || TestChar->Health <= 0)
+		{
+			return;
+		}
+
+		NumCandidates++;
+		const FVector CharLocation = TestChar->GetActorLocation();
+		const FVector LocalLocation = RangeTransform.InverseTransformPositionNoScale(CharLocation);
+		if (FMath::Abs(LocalLocation.X) > RangeExtent.X || FMath::Abs(LocalLocation.Y) > RangeExtent.Y || FMath::Abs(LocalLocation.Z) > RangeExtent.Z)
+		{
+			return;
+		}
+
+		const float DistSq = FVector::DistSquared(CharLocation, Policy == EStrategyTowerTargeting::FirstInPath ? PathGoal : TowerLocation);
+		const bool bIsBetter = (BestTarget == nullptr)
+			|| (Policy == EStrategyTowerTargeting::LowestHealth && TestChar->Health < BestHealth)
+			|| ((Policy != EStrategyTowerTargeting::LowestHealth || TestChar->Health == BestHealth) && DistSq < BestDistSq);
+
+		if (bIsBetter)
+		{
+			BestTarget = TestChar;
+			BestHealth = TestChar->Health;
+			BestDistSq = DistSq;
+		}
+	});
+
+	INC_DWORD_STAT_BY(STAT_StrategyTowerCandidates, NumCandidates);
+	return BestTarget;
+}
@@ -3,9 +3,14 @@
 #include "StrategyGame.h"
 #include "StrategyAIController.h"
 #include "StrategyAttachment.h"
+#include "StrategySpatialGrid.h"
+#include "StrategyActorPoolSubsystem.h"
+#include "StrategyBuffSubsystem.h"
+#include "StrategyHealthRegenSubsystem.h"
+#include "StrategyCombatSubsystem.h"
 
 AStrategyChar::AStrategyChar(const FObjectInitializer& ObjectInitializer) 
-	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCharacterMovementComponent>(ACharacter::CharacterMovementComponentName)), ResourcesToGather(10)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCharacterMovementComponent>(ACharacter::CharacterMovementComponentName)), ResourcesToGather(10), BaseWalkSpeed(0.0f), BaseMaxHealth(0), SpatialGridIndex(INDEX_NONE), BuffListHead(INDEX_NONE), HealthRegenIndex(INDEX_NONE)
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -29,9 +34,64 @@ void AStrategyChar::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 
+	// buffs modify speed relative to value set up in class defaults
+	BaseWalkSpeed = GetCharacterMovement() ? GetCharacterMovement()->MaxWalkSpeed : 0.0f;
+	BaseMaxHealth = GetClass()->GetDefaultObject<AStrategyChar>()->GetHealth();
+
 	// initialization
 	UpdatePawnData();
-	UpdateHealth();
+}
+
+void AStrategyChar::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid && Health > 0.f)
+	{
+		Grid->RegisterChar(this);
+	}
+
+	UStrategyHealthRegenSubsystem* const HealthRegen = GetWorld()->GetSubsystem<UStrategyHealthRegenSubsystem>();
+	if (HealthRegen && Health > 0.f)
+	{
+		HealthRegen->RegisterChar(this);
+	}
+
+	UStrategyTeamRegistry* const TeamRegistry = GetWorld()->GetSubsystem<UStrategyTeamRegistry>();
+	if (TeamRegistry)
+	{
+		TeamRegistry->SetTeam(this, MyTeamNum);
+	}
+}
+
+void AStrategyChar::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid)
+	{
+		Grid->UnregisterChar(this);
+	}
+
+	UStrategyHealthRegenSubsystem* const HealthRegen = GetWorld()->GetSubsystem<UStrategyHealthRegenSubsystem>();
+	if (HealthRegen)
+	{
+		HealthRegen->UnregisterChar(this);
+	}
+
+	UStrategyTeamRegistry* const TeamRegistry = GetWorld()->GetSubsystem<UStrategyTeamRegistry>();
+	if (TeamRegistry)
+	{
+		TeamRegistry->RemoveActor(this);
+	}
+
+	UStrategyBuffSubsystem* const Buffs = GetWorld()->GetSubsystem<UStrategyBuffSubsystem>();
+	if (Buffs)
+	{
+		Buffs->RemoveAllBuffs(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 bool AStrategyChar::CanBeBaseForCharacter(APawn* Pawn) const
@@ -66,35 +126,30 @@ float AStrategyChar::PlayMeleeAnim()
 
 void AStrategyChar::OnMeleeImpactNotify()
 {
-	const TSubclassOf<UDamageType> MeleeDmgType = UDamageType::StaticClass();
-	const int32 MeleeDamage     = FMath::RandRange(ModifiedPawnData.AttackMin, ModifiedPawnData.AttackMax);
-
-	// Do a trace to see what we hit
-	const float CollisionRadius = GetCapsuleComponent() ? GetCapsuleComponent()->GetScaledCapsuleRadius() : 0.f;
-	const float TraceDistance   = CollisionRadius + (ModifiedPawnData.AttackDistance * 1.3f);
-	const FVector TraceStart    = GetActorLocation();
-	const FVector TraceDir      = GetActorForwardVector();
-	const FVector TraceEnd      = TraceStart + TraceDir * TraceDistance;
-
-	TArray<FHitResult> Hits;
-	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(MeleeHit), false, this);
-	FCollisionResponseParams ResponseParam(ECollisionResponse::ECR_Overlap);
-	GetWorld()->SweepMultiByChannel(Hits, TraceStart, TraceEnd, FQuat::Identity, COLLISION_WEAPON, FCollisionShape::MakeBox(FVector(80.f)), TraceParams, ResponseParam);
+	AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+	const int32 MeleeDamage     = GameState ? GameState->GetCombatRandom().RandRange(ModifiedPawnData.AttackMin, ModifiedPawnData.AttackMax) : FMath::RandRange(ModifiedPawnData.AttackMin, ModifiedPawnData.AttackMax);
 
-	for (int32 i=0; i<Hits.Num(); i++)
+	// victim is found at end of frame, together with all other melee impacts
+	UStrategyCombatSubsystem* const Combat = GetWorld()->GetSubsystem<UStrategyCombatSubsystem>();
+	if (Combat)
 	{
-		FHitResult const& Hit = Hits[i];
-		if (AStrategyGameMode::OnEnemyTeam(this, Hit.GetActor()))
-		{
-			UGameplayStatics::ApplyPointDamage(Hit.GetActor(), MeleeDamage, TraceDir, Hit, Controller, this, MeleeDmgType);
-
-			// only damage first hit
-			break;
-		}
+		Combat->QueueMeleeImpact(this, MeleeDamage);
 	}
 }
 
 float AStrategyChar::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (!UStrategyCombatSubsystem::IsEnabled())
+	{
+		return TakeDamageUnbatched(Damage, DamageEvent, EventInstigator, DamageCauser);
+	}
+
+	// damage from projectiles and blueprints takes effect right away, through the same rules as batched damage
+	UStrategyCombatSubsystem* const Combat = GetWorld()->GetSubsystem<UStrategyCombatSubsystem>();
+	return Combat ? Combat->ApplyDamage(this, Damage, DamageEvent, EventInstigator, DamageCauser) : 0.f;
+}
+
+float AStrategyChar::TakeDamageUnbatched(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// no further damage if already dead
 	if (Health <= 0.f)
@@ -128,6 +183,26 @@ float AStrategyChar::TakeDamage(float Damage, struct FDamageEvent const& DamageE
 	return ActualDamage;
 }
 
+void AStrategyChar::NotifyDamageTaken(float Damage, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	const UDamageType* const DamageType = DamageEvent.DamageTypeClass ? DamageEvent.DamageTypeClass->GetDefaultObject<UDamageType>() : GetDefault<UDamageType>();
+
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	{
+		const FPointDamageEvent& PointDamageEvent = static_cast<const FPointDamageEvent&>(DamageEvent);
+		const FHitResult& HitInfo = PointDamageEvent.HitInfo;
+		ReceivePointDamage(Damage, DamageType, HitInfo.ImpactPoint, HitInfo.ImpactNormal, HitInfo.Component.Get(), HitInfo.BoneName, PointDamageEvent.ShotDirection, EventInstigator, DamageCauser, HitInfo);
+		OnTakePointDamage.Broadcast(this, Damage, EventInstigator, HitInfo.ImpactPoint, HitInfo.Component.Get(), HitInfo.BoneName, PointDamageEvent.ShotDirection, DamageType, DamageCauser);
+	}
+
+	ReceiveAnyDamage(Damage, DamageType, EventInstigator, DamageCauser);
+	OnTakeAnyDamage.Broadcast(this, Damage, DamageType, EventInstigator, DamageCauser);
+	if (EventInstigator != nullptr)
+	{
+		EventInstigator->InstigatedAnyDamage(Damage, DamageType, this, DamageCauser);
+	}
+}
+
 void AStrategyChar::FellOutOfWorld(const UDamageType& DamageType)
 {
 	// if we fall out of the world, die
@@ -151,14 +226,24 @@ void AStrategyChar::Die(float KillingDamage, FDamageEvent const& DamageEvent, AC
 	// forcibly end any timers that may be in flight
 	GetWorldTimerManager().ClearAllTimersForObject(this);
 
-	// notify the game mode if an Enemy dies
-	if (GetTeamNum() == EStrategyTeam::Enemy)
+	// dead characters can't be sensed anymore
+	UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid)
 	{
-		AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
-		if (GameState)
-		{
-			GameState->OnCharDied(this);
-		}
+		Grid->UnregisterChar(this);
+	}
+
+	UStrategyHealthRegenSubsystem* const HealthRegen = GetWorld()->GetSubsystem<UStrategyHealthRegenSubsystem>();
+	if (HealthRegen)
+	{
+		HealthRegen->UnregisterChar(this);
+	}
+
+	// notify the game state, deaths of every team are counted
+	AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+	if (GameState)
+	{
+		GameState->OnCharDied(this);
 	}
 
 	// disable any AI
@@ -189,6 +274,13 @@ void AStrategyChar::Die(float KillingDamage, FDamageEvent const& DamageEvent, AC
 		Controller->UnPossess();
 	}	
 
+	// AI controller can be reused by next minion
+	UStrategyActorPoolSubsystem* const Pool = GetWorld()->GetSubsystem<UStrategyActorPoolSubsystem>();
+	if (AIController && Pool)
+	{
+		Pool->ReleaseActor(AIController);
+	}
+
 	// play death animation
 	float DeathAnimDuration = 0.f;
 	if (DeathAnim)
@@ -205,8 +297,134 @@ void AStrategyChar::Die(float KillingDamage, FDamageEvent const& DamageEvent, AC
 void AStrategyChar::OnDieAnimationEnd()
 {
 	this->SetActorHiddenInGame(true);
-	// delete the pawn asap
-	SetLifeSpan( 0.01f );
+
+	// return the pawn to pool, or delete it asap
+	UStrategyActorPoolSubsystem* const Pool = GetWorld()->GetSubsystem<UStrategyActorPoolSubsystem>();
+	if (Pool == nullptr || !Pool->ReleaseActor(this))
+	{
+		SetLifeSpan( 0.01f );
+	}
+}
+
+void AStrategyChar::OnPooled()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid)
+	{
+		Grid->UnregisterChar(this);
+	}
+
+	UStrategyHealthRegenSubsystem* const HealthRegen = GetWorld()->GetSubsystem<UStrategyHealthRegenSubsystem>();
+	if (HealthRegen)
+	{
+		HealthRegen->UnregisterChar(this);
+	}
+
+	// keep attachments for next life, they are given again through TakePooledAttachment
+	UStrategyAttachment* const InvSlots[] = { WeaponSlot, ArmorSlot };
+	for (int32 i = 0; i < UE_ARRAY_COUNT(InvSlots); i++)
+	{
+		if (InvSlots[i])
+		{
+			InvSlots[i]->DetachFromComponent(FDetachmentTransformRules::KeepRelativeTransform);
+			InvSlots[i]->UnregisterComponent();
+			PooledAttachments.AddUnique(InvSlots[i]);
+		}
+	}
+	WeaponSlot = nullptr;
+	ArmorSlot = nullptr;
+
+	UStrategyBuffSubsystem* const Buffs = GetWorld()->GetSubsystem<UStrategyBuffSubsystem>();
+	if (Buffs)
+	{
+		Buffs->RemoveAllBuffs(this);
+	}
+
+	UAnimInstance* const AnimInstance = GetMesh() ? GetMesh()->GetAnimInstance() : nullptr;
+	if (AnimInstance)
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	if (GetCharacterMovement())
+	{
+		GetCharacterMovement()->StopMovementImmediately();
+		GetCharacterMovement()->DisableMovement();
+		GetCharacterMovement()->SetComponentTickEnabled(false);
+	}
+
+	if (GetMesh())
+	{
+		GetMesh()->SetComponentTickEnabled(false);
+	}
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+}
+
+void AStrategyChar::OnUnpooled()
+{
+	const AStrategyChar* const DefaultChar = GetClass()->GetDefaultObject<AStrategyChar>();
+
+	bIsDying = false;
+	Health = DefaultChar->Health;
+	SetTeamNum(EStrategyTeam::Unknown);
+
+	// undo collision changes done in Die
+	if (GetCapsuleComponent())
+	{
+		GetCapsuleComponent()->SetCollisionEnabled(DefaultChar->GetCapsuleComponent()->GetCollisionEnabled());
+		GetCapsuleComponent()->SetCollisionResponseToChannels(DefaultChar->GetCapsuleComponent()->GetCollisionResponseToChannels());
+	}
+
+	if (GetCharacterMovement())
+	{
+		GetCharacterMovement()->SetComponentTickEnabled(true);
+		GetCharacterMovement()->SetDefaultMovementMode();
+	}
+
+	if (GetMesh())
+	{
+		GetMesh()->SetComponentTickEnabled(true);
+		GetMesh()->GlobalAnimRateScale = DefaultChar->GetMesh()->GlobalAnimRateScale;
+	}
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	// same initialization as freshly spawned character
+	UpdatePawnData();
+
+	UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid)
+	{
+		Grid->RegisterChar(this);
+	}
+
+	UStrategyHealthRegenSubsystem* const HealthRegen = GetWorld()->GetSubsystem<UStrategyHealthRegenSubsystem>();
+	if (HealthRegen)
+	{
+		HealthRegen->RegisterChar(this);
+	}
+}
+
+UStrategyAttachment* AStrategyChar::TakePooledAttachment(TSubclassOf<UStrategyAttachment> AttachmentClass)
+{
+	for (int32 i = 0; i < PooledAttachments.Num(); i++)
+	{
+		UStrategyAttachment* const Attachment = PooledAttachments[i];
+		if (Attachment && Attachment->GetClass() == AttachmentClass)
+		{
+			PooledAttachments.RemoveAtSwap(i);
+			return Attachment;
+		}
+	}
+
+	return nullptr;
 }
 
 void AStrategyChar::SetWeaponAttachment(UStrategyAttachment* Weapon)
@@ -226,7 +444,6 @@ void AStrategyChar::SetWeaponAttachment(UStrategyAttachment* Weapon)
 			WeaponSlot->RegisterComponent();
 			WeaponSlot->AttachToComponent(GetMesh(), FAttachmentTransformRules::KeepRelativeTransform, WeaponSlot->AttachPoint);
 			UpdatePawnData();
-			UpdateHealth();
 		}
 	}
 }
@@ -248,7 +465,6 @@ void AStrategyChar::SetArmorAttachment(UStrategyAttachment* Armor)
 			ArmorSlot->RegisterComponent();
 			ArmorSlot->AttachToComponent(GetMesh(), FAttachmentTransformRules::KeepRelativeTransform, ArmorSlot->AttachPoint);
 			UpdatePawnData();
-			UpdateHealth();
 		}
 	}
 }
@@ -271,26 +487,33 @@ uint8 AStrategyChar::GetTeamNum() const
 void AStrategyChar::SetTeamNum(uint8 NewTeamNum)
 {
 	MyTeamNum = NewTeamNum;
+
+	// AI controllers take team of their pawn
+	UStrategyTeamRegistry* const TeamRegistry = GetWorld() ? GetWorld()->GetSubsystem<UStrategyTeamRegistry>() : nullptr;
+	if (TeamRegistry)
+	{
+		TeamRegistry->SetTeam(this, MyTeamNum);
+		if (Cast<AStrategyAIController>(Controller))
+		{
+			TeamRegistry->SetTeam(Controller, MyTeamNum);
+		}
+	}
 }
 
 void AStrategyChar::ApplyBuff(const FBuffData& Buff)
 {
-	// calc the end time
-	FBuffData NewBuff = Buff;
-	if (!Buff.bInfiniteDuration)
+	// add to active buffs, buff subsystem removes it once it expires
+	UStrategyBuffSubsystem* const Buffs = GetWorld()->GetSubsystem<UStrategyBuffSubsystem>();
+	if (Buffs)
 	{
-		NewBuff.EndTime = GetWorld()->GetTimeSeconds() + Buff.Duration;
+		Buffs->AddBuff(this, Buff);
 	}
 
-	// add to active buffs
-	ActiveBuffs.Add(NewBuff);
-
 	// update to account for changes
 	UpdatePawnData();
-	UpdateHealth();
 }
 
-void FBuffData::ApplyBuff(struct FPawnData& PawnData)
+void FBuffData::ApplyBuff(struct FPawnData& PawnData) const
 {
 	PawnData.AttackMin       += BuffData.AttackMin;
 	PawnData.AttackMax       += BuffData.AttackMax;
@@ -302,29 +525,14 @@ void FBuffData::ApplyBuff(struct FPawnData& PawnData)
 
 void AStrategyChar::UpdatePawnData()
 {
-	const float CurrentTime  = GetWorld()->GetTimeSeconds();
-	float TimeToNextUpdate   = -1.f;
-
 	// start from existing base data
 	FPawnData NewPawnData    = PawnData;
 
 	// add in influence of any active buffs
-	for (int32 i = 0; i < ActiveBuffs.Num(); i++)
+	const UStrategyBuffSubsystem* const Buffs = GetWorld()->GetSubsystem<UStrategyBuffSubsystem>();
+	if (Buffs)
 	{
-		// expired buff, clear it out
-		if (!ActiveBuffs[i].bInfiniteDuration && CurrentTime >= ActiveBuffs[i].EndTime)
-		{
-			ActiveBuffs.RemoveAt(i);
-			i--;
-			continue;
-		}
-
-		if (TimeToNextUpdate < 0 || TimeToNextUpdate > ActiveBuffs[i].EndTime - CurrentTime)
-		{
-			TimeToNextUpdate = ActiveBuffs[i].EndTime - CurrentTime;
-		}
-
-		ActiveBuffs[i].ApplyBuff(NewPawnData);
+		Buffs->AccumulateBuffs(this, NewPawnData);
 	}
 	
 	// add influence of any attachments
@@ -352,36 +560,17 @@ void AStrategyChar::UpdatePawnData()
 	// update groundspeed
 	if (GetCharacterMovement())
 	{
-		GetCharacterMovement()->MaxWalkSpeed = FMath::Max(0.0f, GetClass()->GetDefaultObject<AStrategyChar>()->GetCharacterMovement()->MaxWalkSpeed + NewPawnData.Speed);
+		GetCharacterMovement()->MaxWalkSpeed = FMath::Max(0.0f, BaseWalkSpeed + NewPawnData.Speed);
 	}
 
-	// update the buffs next time any expires, they are also updated when any buff is added
-	if (TimeToNextUpdate > 0.f)
+	// health regen keeps its own copy of regen and max health
+	UStrategyHealthRegenSubsystem* const HealthRegen = GetWorld()->GetSubsystem<UStrategyHealthRegenSubsystem>();
+	if (HealthRegen)
 	{
-		GetWorldTimerManager().SetTimer(TimerHandle_UpdatePawnData, this, &AStrategyChar::UpdatePawnData, TimeToNextUpdate, false);
+		HealthRegen->UpdateChar(this);
 	}
 }
 
-void AStrategyChar::UpdateHealth()
-{
-	if ( (Health > 0.f) && (ModifiedPawnData.HealthRegen != 0.f) )
-	{
-		if (ModifiedPawnData.HealthRegen < 0.f)
-		{
-			// negative health regen is a DoT, so do the damage
-			UGameplayStatics::ApplyDamage(this, -ModifiedPawnData.HealthRegen, Controller, this, UDamageType::StaticClass());
-		}
-		else
-		{
-			// add health regen
-			Health = FMath::Min<int32>(Health + ModifiedPawnData.HealthRegen, GetMaxHealth());
-		}
-	}
-
-	// update again in 1 second
-	GetWorldTimerManager().SetTimer(TimerHandle_UpdateHealth, this, &AStrategyChar::UpdateHealth, 1.0f, false);
-}
-
 const struct FPawnData* AStrategyChar::GetPawnData() const
 {
 	return &ModifiedPawnData;
@@ -394,6 +583,6 @@ int32 AStrategyChar::GetHealth() const
 
 int32 AStrategyChar::GetMaxHealth() const
 {
-	return GetClass()->GetDefaultObject<AStrategyChar>()->GetHealth() + ModifiedPawnData.MaxHealthBonus;
+	return BaseMaxHealth + ModifiedPawnData.MaxHealthBonus;
 }
 
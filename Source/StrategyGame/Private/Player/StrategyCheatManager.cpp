@@ -2,6 +2,8 @@
 
 #include "StrategyGame.h"
 #include "StrategyCheatManager.h"
+#include "StrategyBuilding_Brewery.h"
+#include "StrategyAIDirector.h"
 
 UStrategyCheatManager::UStrategyCheatManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -25,3 +27,23 @@ void UStrategyCheatManager::AddGold(uint32 NewGold)
 		}
 	}
 }
+
+void UStrategyCheatManager::StressWave(int32 NumMinions)
+{
+	AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+	FPlayerData* const TeamData = (MyGameState) ? MyGameState->GetPlayerData(EStrategyTeam::Enemy) : NULL;
+	UStrategyAIDirector* const AIDirector = (TeamData && TeamData->Brewery.IsValid()) ? TeamData->Brewery->GetAIDirector() : NULL;
+
+	if (AIDirector && NumMinions > 0)
+	{
+		AIDirector->SpawnMode = EStrategySpawnMode::Batched;
+		AIDirector->WaveSize += NumMinions;
+
+		AStrategyPlayerController* MyPC = Cast<AStrategyPlayerController>(GetOuter());
+		if (MyPC)
+		{
+			FString Str = FString::Printf(TEXT("Stress wave: %d"), NumMinions);
+			MyPC->ClientMessage(Str);
+		}
+	}
+}
@@ -100,6 +100,19 @@ void AStrategyPlayerController::UpdateRotation(float DeltaTime)
 	SetControlRotation(ViewRotation);
 }
 
+void AStrategyPlayerController::UpdateCameraManager(float DeltaSeconds)
+{
+	Super::UpdateCameraManager(DeltaSeconds);
+
+	// AI level of detail is based on distance to this point
+	AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
+	if (MyGameState != nullptr && IsLocalController())
+	{
+		MyGameState->CameraFocalLocation = GetFocalLocation();
+		MyGameState->bHasCameraFocalLocation = true;
+	}
+}
+
 void AStrategyPlayerController::ProcessPlayerInput(const float DeltaTime, const bool bGamePaused)
 {
 	if (!bGamePaused && PlayerInput && InputHandler && !bIgnoreInput)
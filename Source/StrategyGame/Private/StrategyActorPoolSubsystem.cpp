@@ -0,0 +1,113 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyActorPoolSubsystem.h"
+#include "StrategyPoolableInterface.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled actors reused"), STAT_StrategyPoolReused, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled actors spawned"), STAT_StrategyPoolSpawned, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled actors released"), STAT_StrategyPoolReleased, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarActorPoolEnabled(TEXT("Strategy.Pool.Enabled"), 1, TEXT("If set, minions, their controllers and projectiles are recycled instead of being spawned and destroyed."));
+
+UStrategyActorPoolSubsystem::UStrategyActorPoolSubsystem()
+{
+}
+
+void UStrategyActorPoolSubsystem::Deinitialize()
+{
+	Pools.Reset();
+	Super::Deinitialize();
+}
+
+bool UStrategyActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UStrategyActorPoolSubsystem::IsEnabled()
+{
+	return CVarActorPoolEnabled.GetValueOnGameThread() != 0;
+}
+
+AActor* UStrategyActorPoolSubsystem::SpawnActor(UClass* ActorClass, const FVector& Location, const FRotator& Rotation) const
+{
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* const NewActor = GetWorld()->SpawnActor<AActor>(ActorClass, Location, Rotation, SpawnInfo);
+	if (NewActor != nullptr)
+	{
+		INC_DWORD_STAT(STAT_StrategyPoolSpawned);
+	}
+
+	return NewActor;
+}
+
+AActor* UStrategyActorPoolSubsystem::AcquireActor(UClass* ActorClass, const FVector& Location, const FRotator& Rotation)
+{
+	if (ActorClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	TArray<TWeakObjectPtr<AActor>>* const Pool = IsEnabled() ? Pools.Find(ActorClass) : nullptr;
+	while (Pool != nullptr && Pool->Num() > 0)
+	{
+		AActor* const PooledActor = Pool->Pop(false).Get();
+		if (PooledActor == nullptr || PooledActor->IsPendingKillPending())
+		{
+			continue;
+		}
+
+		PooledActor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		CastChecked<IStrategyPoolableInterface>(PooledActor)->OnUnpooled();
+
+		INC_DWORD_STAT(STAT_StrategyPoolReused);
+		return PooledActor;
+	}
+
+	return SpawnActor(ActorClass, Location, Rotation);
+}
+
+bool UStrategyActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	IStrategyPoolableInterface* const Poolable = Cast<IStrategyPoolableInterface>(Actor);
+	if (Poolable == nullptr || !IsEnabled() || Actor->IsPendingKillPending() || Actor->GetWorld() != GetWorld())
+	{
+		return false;
+	}
+
+	Poolable->OnPooled();
+	Pools.FindOrAdd(Actor->GetClass()).Add(Actor);
+
+	INC_DWORD_STAT(STAT_StrategyPoolReleased);
+	return true;
+}
+
+void UStrategyActorPoolSubsystem::Prewarm(UClass* ActorClass, int32 Count)
+{
+	if (ActorClass == nullptr || !ActorClass->ImplementsInterface(UStrategyPoolableInterface::StaticClass()) || !IsEnabled())
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AActor>>& Pool = Pools.FindOrAdd(ActorClass);
+	Pool.RemoveAllSwap([](const TWeakObjectPtr<AActor>& PooledActor) { return !PooledActor.IsValid(); });
+
+	const int32 NumToSpawn = Count - Pool.Num();
+	for (int32 Idx = 0; Idx < NumToSpawn; Idx++)
+	{
+		AActor* const NewActor = SpawnActor(ActorClass, FVector::ZeroVector, FRotator::ZeroRotator);
+		if (NewActor == nullptr || !ReleaseActor(NewActor))
+		{
+			break;
+		}
+	}
+}
+
+int32 UStrategyActorPoolSubsystem::GetNumPooled(UClass* ActorClass) const
+{
+	const TArray<TWeakObjectPtr<AActor>>* const Pool = Pools.Find(ActorClass);
+	return Pool != nullptr ? Pool->Num() : 0;
+}
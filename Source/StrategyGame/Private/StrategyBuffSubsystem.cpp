@@ -0,0 +1,158 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyBuffSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Buff expiry"), STAT_StrategyBuffExpiry, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buffs expired"), STAT_StrategyBuffsExpired, STATGROUP_StrategyAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active buffs"), STAT_StrategyActiveBuffs, STATGROUP_StrategyAI);
+
+UStrategyBuffSubsystem::UStrategyBuffSubsystem()
+{
+}
+
+void UStrategyBuffSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	FreeEntries.Empty();
+	ExpiryHeap.Empty();
+	ExpiredChars.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UStrategyBuffSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyBuffSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyBuffSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyBuffSubsystem::Tick(float DeltaTime)
+{
+	if (ExpiryHeap.Num() > 0 && ExpiryHeap.HeapTop().EndTime <= GetWorld()->GetTimeSeconds())
+	{
+		ExpireBuffs(GetWorld()->GetTimeSeconds());
+	}
+}
+
+void UStrategyBuffSubsystem::AddBuff(AStrategyChar* InChar, const FBuffData& Buff)
+{
+	if (InChar == nullptr)
+	{
+		return;
+	}
+
+	int32 EntryIndex = INDEX_NONE;
+	if (FreeEntries.Num() > 0)
+	{
+		EntryIndex = FreeEntries.Pop(false);
+	}
+	else
+	{
+		EntryIndex = Entries.AddZeroed();
+	}
+
+	// link as head of character's list
+	FBuffEntry& Entry = Entries[EntryIndex];
+	Entry.Char = InChar;
+	Entry.Buff = Buff;
+	Entry.Buff.EndTime = Buff.bInfiniteDuration ? MAX_FLT : GetWorld()->GetTimeSeconds() + Buff.Duration;
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = InChar->BuffListHead;
+	Entry.Serial++;
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = EntryIndex;
+	}
+	InChar->BuffListHead = EntryIndex;
+
+	if (!Buff.bInfiniteDuration)
+	{
+		FBuffExpiry Expiry;
+		Expiry.EndTime = Entry.Buff.EndTime;
+		Expiry.EntryIndex = EntryIndex;
+		Expiry.Serial = Entry.Serial;
+		ExpiryHeap.HeapPush(Expiry);
+	}
+
+	INC_DWORD_STAT(STAT_StrategyActiveBuffs);
+}
+
+void UStrategyBuffSubsystem::RemoveEntry(int32 EntryIndex)
+{
+	FBuffEntry& Entry = Entries[EntryIndex];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		Entry.Char->BuffListHead = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+
+	// expiry left in heap is recognized as stale by serial
+	Entry.Char = nullptr;
+	Entry.Serial++;
+	FreeEntries.Add(EntryIndex);
+
+	DEC_DWORD_STAT(STAT_StrategyActiveBuffs);
+}
+
+void UStrategyBuffSubsystem::RemoveAllBuffs(AStrategyChar* InChar)
+{
+	while (InChar != nullptr && Entries.IsValidIndex(InChar->BuffListHead))
+	{
+		RemoveEntry(InChar->BuffListHead);
+	}
+}
+
+void UStrategyBuffSubsystem::AccumulateBuffs(const AStrategyChar* InChar, FPawnData& PawnData) const
+{
+	for (int32 EntryIndex = InChar->BuffListHead; EntryIndex != INDEX_NONE; EntryIndex = Entries[EntryIndex].Next)
+	{
+		Entries[EntryIndex].Buff.ApplyBuff(PawnData);
+	}
+}
+
+int32 UStrategyBuffSubsystem::ExpireBuffs(float CurrentTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyBuffExpiry);
+
+	ExpiredChars.Reset();
+	while (ExpiryHeap.Num() > 0 && ExpiryHeap.HeapTop().EndTime <= CurrentTime)
+	{
+		FBuffExpiry Expiry;
+		ExpiryHeap.HeapPop(Expiry, false);
+
+		FBuffEntry& Entry = Entries[Expiry.EntryIndex];
+		if (Entry.Serial == Expiry.Serial && Entry.Char != nullptr)
+		{
+			ExpiredChars.Add(Entry.Char);
+			RemoveEntry(Expiry.EntryIndex);
+			INC_DWORD_STAT(STAT_StrategyBuffsExpired);
+		}
+	}
+
+	// each character is updated once, no matter how many of its buffs ended
+	for (AStrategyChar* ExpiredChar : ExpiredChars)
+	{
+		ExpiredChar->UpdatePawnData();
+	}
+
+	return ExpiredChars.Num();
+}
+
+int32 UStrategyBuffSubsystem::GetNumBuffs() const
+{
+	return Entries.Num() - FreeEntries.Num();
+}
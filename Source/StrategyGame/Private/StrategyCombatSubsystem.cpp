@@ -0,0 +1,390 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyCombatSubsystem.h"
+#include "StrategySpatialGrid.h"
+#include "StrategyTeamRegistry.h"
+#include "StrategyTeamInterface.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee resolution"), STAT_StrategyMeleeResolve, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee impacts"), STAT_StrategyMeleeImpacts, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee sweep mismatches"), STAT_StrategyMeleeMismatches, STATGROUP_StrategyAI);
+DECLARE_CYCLE_STAT(TEXT("Damage resolution"), STAT_StrategyDamageResolve, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage events"), STAT_StrategyDamageEvents, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarMeleeSweepMode(TEXT("Strategy.Combat.MeleeSweep"), 0,
+	TEXT("How melee impacts find their victim.\n")
+	TEXT(" 0: box test against characters in spatial grid\n")
+	TEXT(" 1: physics box sweep on weapon channel\n")
+	TEXT(" 2: spatial grid, validated against physics sweep"));
+
+static TAutoConsoleVariable<int32> CVarBatchDamage(TEXT("Strategy.Combat.BatchDamage"), 1,
+	TEXT("If set, damage to characters is collected and resolved in batches by combat subsystem.\n")
+	TEXT("Otherwise every hit goes through TakeDamage and game mode rules right away."));
+
+/** half size of melee hit box */
+static const float MeleeBoxExtent = 80.0f;
+
+UStrategyCombatSubsystem::UStrategyCombatSubsystem()
+	: TeamRegistry(nullptr)
+{
+}
+
+void UStrategyCombatSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency(UStrategyTeamRegistry::StaticClass());
+	TeamRegistry = GetWorld()->GetSubsystem<UStrategyTeamRegistry>();
+}
+
+void UStrategyCombatSubsystem::Deinitialize()
+{
+	MeleeRequests.Empty();
+	MeleeHits.Empty();
+	DamageQueue.Empty();
+	DamageBatch.Empty();
+	PointDamageQueue.Empty();
+	PointDamageBatch.Empty();
+	TeamRegistry = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UStrategyCombatSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyCombatSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyCombatSubsystem, STATGROUP_Tickables);
+}
+
+bool UStrategyCombatSubsystem::IsEnabled()
+{
+	return CVarBatchDamage.GetValueOnGameThread() != 0;
+}
+
+void UStrategyCombatSubsystem::Tick(float DeltaTime)
+{
+	if (MeleeRequests.Num() > 0)
+	{
+		ResolveMeleeImpacts();
+	}
+
+	if (DamageQueue.Num() > 0)
+	{
+		FlushDamage();
+	}
+}
+
+void UStrategyCombatSubsystem::QueueMeleeImpact(AStrategyChar* Attacker, int32 Damage)
+{
+	if (Attacker == nullptr)
+	{
+		return;
+	}
+
+	const float CollisionRadius = Attacker->GetCapsuleComponent() ? Attacker->GetCapsuleComponent()->GetScaledCapsuleRadius() : 0.f;
+
+	FMeleeRequest& Request = MeleeRequests[MeleeRequests.AddUninitialized()];
+	Request.Attacker   = Attacker;
+	Request.Instigator = Attacker->GetController();
+	Request.Damage     = Damage;
+	Request.Start      = Attacker->GetActorLocation();
+	Request.Dir        = Attacker->GetActorForwardVector();
+	Request.Distance   = CollisionRadius + (Attacker->GetPawnData()->AttackDistance * 1.3f);
+}
+
+int32 UStrategyCombatSubsystem::GetNumPendingMeleeImpacts() const
+{
+	return MeleeRequests.Num();
+}
+
+void UStrategyCombatSubsystem::ResolveMeleeImpacts()
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyMeleeResolve);
+	INC_DWORD_STAT_BY(STAT_StrategyMeleeImpacts, MeleeRequests.Num());
+
+	const int32 SweepMode = CVarMeleeSweepMode.GetValueOnGameThread();
+	const UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+
+	// all victims are found before any damage is done, so every blow sees the same state of the world
+	MeleeHits.Reset();
+	for (int32 Idx = 0; Idx < MeleeRequests.Num(); Idx++)
+	{
+		const FMeleeRequest& Request = MeleeRequests[Idx];
+		if (!IsValid(Request.Attacker))
+		{
+			continue;
+		}
+
+		FMeleeHit MeleeHit;
+		MeleeHit.RequestIndex = Idx;
+
+		const bool bUseSweep = (SweepMode == 1 || Grid == nullptr);
+		const bool bFound = bUseSweep ? FindVictimBySweep(Request, MeleeHit.Hit) : FindVictimInGrid(*Grid, Request, MeleeHit.Hit);
+
+		if (SweepMode == 2 && !bUseSweep)
+		{
+			FHitResult SweepHit;
+			FindVictimBySweep(Request, SweepHit);
+			if (SweepHit.GetActor() != MeleeHit.Hit.GetActor())
+			{
+				INC_DWORD_STAT(STAT_StrategyMeleeMismatches);
+				UE_LOG(LogGame, Warning, TEXT("Melee of %s: grid hit %s, sweep hit %s"), *Request.Attacker->GetName(),
+					MeleeHit.Hit.GetActor() ? *MeleeHit.Hit.GetActor()->GetName() : TEXT("NONE"), SweepHit.GetActor() ? *SweepHit.GetActor()->GetName() : TEXT("NONE"));
+			}
+		}
+
+		if (bFound)
+		{
+			MeleeHits.Add(MeleeHit);
+		}
+	}
+
+	// characters go to damage queue, anything else found by physics sweep takes damage right away
+	const TSubclassOf<UDamageType> MeleeDmgType = UDamageType::StaticClass();
+	for (const FMeleeHit& MeleeHit : MeleeHits)
+	{
+		const FMeleeRequest& Request = MeleeRequests[MeleeHit.RequestIndex];
+		AController* const Instigator = IsValid(Request.Instigator) ? Request.Instigator : nullptr;
+		AActor* const Victim = MeleeHit.Hit.GetActor();
+		AStrategyChar* const VictimChar = Cast<AStrategyChar>(Victim);
+		const FPointDamageEvent DamageEvent(Request.Damage, MeleeHit.Hit, Request.Dir, MeleeDmgType);
+		if (VictimChar)
+		{
+			QueueDamage(VictimChar, Request.Damage, DamageEvent, Instigator, Request.Attacker);
+		}
+		else if (IsValid(Victim))
+		{
+			Victim->TakeDamage(Request.Damage, DamageEvent, Instigator, Request.Attacker);
+		}
+	}
+
+	MeleeRequests.Reset();
+	MeleeHits.Reset();
+}
+
+bool UStrategyCombatSubsystem::FindVictimInGrid(const UStrategySpatialGrid& Grid, const FMeleeRequest& Request, FHitResult& OutHit) const
+{
+	AStrategyChar* BestChar = nullptr;
+	float BestDistance = MAX_FLT;
+
+	// corners of hit box and capsules of victims reach beyond sweep distance
+	Grid.ForEachCharInRadius(Request.Start, Request.Distance + MeleeBoxExtent * 2.0f, [&Request, &BestChar, &BestDistance](AStrategyChar* TestChar)
+	{
+		if (TestChar == Request.Attacker || !AStrategyGameMode::OnEnemyTeam(Request.Attacker, TestChar))
+		{
+			return;
+		}
+
+		// box around closest point of sweep, grown by victim's capsule
+		const UCapsuleComponent* const Capsule = TestChar->GetCapsuleComponent();
+		const float Radius = Capsule ? Capsule->GetScaledCapsuleRadius() : 0.f;
+		const float HalfHeight = Capsule ? Capsule->GetScaledCapsuleHalfHeight() : 0.f;
+
+		const FVector Delta = TestChar->GetActorLocation() - Request.Start;
+		const float Distance = FMath::Clamp(FVector::DotProduct(Delta, Request.Dir), 0.0f, Request.Distance);
+		const FVector Offset = Delta - Request.Dir * Distance;
+
+		if (FMath::Abs(Offset.X) <= MeleeBoxExtent + Radius && FMath::Abs(Offset.Y) <= MeleeBoxExtent + Radius && FMath::Abs(Offset.Z) <= MeleeBoxExtent + HalfHeight
+			&& Distance < BestDistance)
+		{
+			BestChar = TestChar;
+			BestDistance = Distance;
+		}
+	});
+
+	if (BestChar == nullptr)
+	{
+		return false;
+	}
+
+	OutHit = FHitResult(BestChar, BestChar->GetCapsuleComponent(), BestChar->GetActorLocation(), -Request.Dir);
+	OutHit.TraceStart = Request.Start;
+	OutHit.TraceEnd = Request.Start + Request.Dir * Request.Distance;
+	return true;
+}
+
+bool UStrategyCombatSubsystem::FindVictimBySweep(const FMeleeRequest& Request, FHitResult& OutHit) const
+{
+	TArray<FHitResult> Hits;
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(MeleeHit), false, Request.Attacker);
+	FCollisionResponseParams ResponseParam(ECollisionResponse::ECR_Overlap);
+	GetWorld()->SweepMultiByChannel(Hits, Request.Start, Request.Start + Request.Dir * Request.Distance, FQuat::Identity, COLLISION_WEAPON, FCollisionShape::MakeBox(FVector(MeleeBoxExtent)), TraceParams, ResponseParam);
+
+	// only first hit enemy takes damage
+	for (int32 i = 0; i < Hits.Num(); i++)
+	{
+		if (AStrategyGameMode::OnEnemyTeam(Request.Attacker, Hits[i].GetActor()))
+		{
+			OutHit = Hits[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** get team byte of actor, through registry if it's enabled */
+static uint8 GetDamageTeam(const UStrategyTeamRegistry* TeamRegistry, const AActor* Actor)
+{
+	if (TeamRegistry != nullptr && UStrategyTeamRegistry::IsEnabled())
+	{
+		return TeamRegistry->GetTeam(Actor);
+	}
+
+	const IStrategyTeamInterface* const TeamInterface = Cast<const IStrategyTeamInterface>(Actor);
+	return TeamInterface != nullptr ? TeamInterface->GetTeamNum() : UStrategyTeamRegistry::NoTeam;
+}
+
+void UStrategyCombatSubsystem::InitDamageEntry(FDamageEntry& Entry, AStrategyChar* Victim, float Damage, FDamageEvent const& DamageEvent, AController* Instigator, AActor* Causer) const
+{
+	Entry.Victim           = Victim;
+	Entry.Instigator       = Instigator;
+	Entry.Causer           = Causer;
+	Entry.Damage           = Damage;
+	Entry.VictimTeam       = GetDamageTeam(TeamRegistry, Victim);
+	Entry.InstigatorTeam   = GetDamageTeam(TeamRegistry, Instigator);
+	Entry.AttackerTeam     = (Entry.InstigatorTeam != UStrategyTeamRegistry::NoTeam) ? Entry.InstigatorTeam : GetDamageTeam(TeamRegistry, Causer);
+	Entry.DamageTypeClass  = DamageEvent.DamageTypeClass;
+	Entry.PointDamageIndex = INDEX_NONE;
+}
+
+void UStrategyCombatSubsystem::QueueDamage(AStrategyChar* Victim, float Damage, FDamageEvent const& DamageEvent, AController* Instigator, AActor* Causer)
+{
+	if (Victim == nullptr || Damage <= 0.f)
+	{
+		return;
+	}
+
+	if (!IsEnabled())
+	{
+		Victim->TakeDamage(Damage, DamageEvent, Instigator, Causer);
+		return;
+	}
+
+	FDamageEntry& Entry = DamageQueue[DamageQueue.AddUninitialized()];
+	InitDamageEntry(Entry, Victim, Damage, DamageEvent, Instigator, Causer);
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	{
+		Entry.PointDamageIndex = PointDamageQueue.Add(static_cast<const FPointDamageEvent&>(DamageEvent));
+	}
+}
+
+int32 UStrategyCombatSubsystem::GetNumPendingDamage() const
+{
+	return DamageQueue.Num();
+}
+
+void UStrategyCombatSubsystem::FlushDamage()
+{
+	// events of this batch may queue more damage, it waits for next flush
+	Exchange(DamageQueue, DamageBatch);
+	Exchange(PointDamageQueue, PointDamageBatch);
+	ResolveDamage(DamageBatch.GetData(), DamageBatch.Num(), PointDamageBatch.GetData());
+	DamageBatch.Reset();
+	PointDamageBatch.Reset();
+}
+
+float UStrategyCombatSubsystem::ApplyDamage(AStrategyChar* Victim, float Damage, FDamageEvent const& DamageEvent, AController* Instigator, AActor* Causer)
+{
+	if (Victim == nullptr || Damage <= 0.f)
+	{
+		return 0.f;
+	}
+
+	FDamageEntry Entry;
+	InitDamageEntry(Entry, Victim, Damage, DamageEvent, Instigator, Causer);
+
+	const bool bPointDamage = DamageEvent.IsOfType(FPointDamageEvent::ClassID);
+	Entry.PointDamageIndex = bPointDamage ? 0 : INDEX_NONE;
+	ResolveDamage(&Entry, 1, bPointDamage ? &static_cast<const FPointDamageEvent&>(DamageEvent) : nullptr);
+	return Entry.Damage;
+}
+
+void UStrategyCombatSubsystem::ResolveDamage(FDamageEntry* Entries, int32 NumEntries, const FPointDamageEvent* PointDamageEvents)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyDamageResolve);
+	INC_DWORD_STAT_BY(STAT_StrategyDamageEvents, NumEntries);
+
+	// no health changes after game is finished
+	const AStrategyGameMode* const Game = GetWorld()->GetAuthGameMode<AStrategyGameMode>();
+	if (Game == nullptr || Game->GetGameplayState() == EGameplayState::Finished)
+	{
+		for (int32 Idx = 0; Idx < NumEntries; Idx++)
+		{
+			Entries[Idx].Damage = 0.f;
+		}
+		return;
+	}
+
+	// game rules: skip friendly fire, subtract pawn's damage reduction
+	for (int32 Idx = 0; Idx < NumEntries; Idx++)
+	{
+		FDamageEntry& Entry = Entries[Idx];
+		const bool bFriendlyFire = (Entry.AttackerTeam != UStrategyTeamRegistry::NoTeam && Entry.AttackerTeam == Entry.VictimTeam);
+		Entry.Damage = (bFriendlyFire || !IsValid(Entry.Victim)) ? 0.f : Entry.Damage - Entry.Victim->GetPawnData()->DamageReduction;
+	}
+
+	// change health, no further damage once victim is dead
+	TArray<int32, TInlineAllocator<16>> KillingBlows;
+	for (int32 Idx = 0; Idx < NumEntries; Idx++)
+	{
+		FDamageEntry& Entry = Entries[Idx];
+		if (Entry.Damage > 0.f && Entry.Victim->Health > 0.f)
+		{
+			Entry.Victim->Health -= Entry.Damage;
+			if (Entry.Victim->Health <= 0.f)
+			{
+				KillingBlows.Add(Idx);
+			}
+		}
+		else
+		{
+			Entry.Damage = 0.f;
+		}
+	}
+
+	// damage events and damage done by each team
+	TArray<int32, TInlineAllocator<8>> DamageDone;
+	for (int32 Idx = 0; Idx < NumEntries; Idx++)
+	{
+		const FDamageEntry& Entry = Entries[Idx];
+		if (Entry.Damage > 0.f)
+		{
+			const FDamageEvent AnyDamageEvent(Entry.DamageTypeClass);
+			const FDamageEvent& DamageEvent = (Entry.PointDamageIndex != INDEX_NONE) ? PointDamageEvents[Entry.PointDamageIndex] : AnyDamageEvent;
+			Entry.Victim->NotifyDamageTaken(Entry.Damage, DamageEvent, Entry.Instigator, Entry.Causer);
+
+			if (Entry.InstigatorTeam != UStrategyTeamRegistry::NoTeam)
+			{
+				if (Entry.InstigatorTeam >= DamageDone.Num())
+				{
+					DamageDone.AddZeroed(Entry.InstigatorTeam + 1 - DamageDone.Num());
+				}
+				DamageDone[Entry.InstigatorTeam] += FMath::TruncToInt(Entry.Damage);
+			}
+		}
+	}
+
+	AStrategyGameState* const GameState = GetWorld()->GetGameState<AStrategyGameState>();
+	for (int32 TeamNum = 0; GameState != nullptr && TeamNum < DamageDone.Num(); TeamNum++)
+	{
+		if (DamageDone[TeamNum] > 0)
+		{
+			GameState->AddDamageDone(TeamNum, DamageDone[TeamNum]);
+		}
+	}
+
+	// deaths last, after all victims got their damage events
+	for (int32 Idx : KillingBlows)
+	{
+		const FDamageEntry& Entry = Entries[Idx];
+		const FDamageEvent AnyDamageEvent(Entry.DamageTypeClass);
+		const FDamageEvent& DamageEvent = (Entry.PointDamageIndex != INDEX_NONE) ? PointDamageEvents[Entry.PointDamageIndex] : AnyDamageEvent;
+		Entry.Victim->Die(Entry.Damage, DamageEvent, Entry.Instigator, Entry.Causer);
+	}
+}
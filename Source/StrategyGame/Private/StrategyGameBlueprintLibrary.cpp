@@ -5,6 +5,8 @@
 #include "SStrategyTitle.h"
 #include "StrategyProjectile.h"
 #include "StrategyAttachment.h"
+#include "StrategyBuilding.h"
+#include "StrategyActorPoolSubsystem.h"
 
 UStrategyGameBlueprintLibrary::UStrategyGameBlueprintLibrary(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -41,10 +43,23 @@ AStrategyProjectile* UStrategyGameBlueprintLibrary::SpawnProjectileFromClass(UOb
 	UWorld* const MyWorld = GEngine->GetWorldFromContextObjectChecked(WorldContextObject);
 	if (*ProjectileClass)
 	{
-		FActorSpawnParameters SpawnInfo;
-		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AStrategyProjectile* Proj = nullptr;
+		UStrategyActorPoolSubsystem* const Pool = MyWorld->GetSubsystem<UStrategyActorPoolSubsystem>();
+		if (Pool)
+		{
+			if (InOwner)
+			{
+				InOwner->PrewarmProjectilePool(*ProjectileClass);
+			}
+			Proj = Pool->AcquireActor<AStrategyProjectile>(*ProjectileClass, SpawnLocation, ShootDirection.Rotation());
+		}
+		else
+		{
+			FActorSpawnParameters SpawnInfo;
+			SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			Proj = MyWorld->SpawnActor<AStrategyProjectile>(*ProjectileClass, SpawnLocation, ShootDirection.Rotation(), SpawnInfo);
+		}
 
-		AStrategyProjectile* const Proj = MyWorld->SpawnActor<AStrategyProjectile>(*ProjectileClass, SpawnLocation, ShootDirection.Rotation(), SpawnInfo);
 		if (Proj)
 		{
 			Proj->Building = InOwner;
@@ -85,7 +100,11 @@ void UStrategyGameBlueprintLibrary::GiveWeaponFromClass(AStrategyChar* InChar, T
 {
 	if (InChar && *ArmorClass)
 	{
-		auto MyWeapon = NewObject<UStrategyAttachment>(InChar, *ArmorClass);
+		UStrategyAttachment* MyWeapon = InChar->TakePooledAttachment(ArmorClass);
+		if (MyWeapon == nullptr)
+		{
+			MyWeapon = NewObject<UStrategyAttachment>(InChar, *ArmorClass);
+		}
 		InChar->SetWeaponAttachment(MyWeapon);
 	}
 }
@@ -99,7 +118,11 @@ void UStrategyGameBlueprintLibrary::GiveArmorFromClass(AStrategyChar* InChar, TS
 {
 	if (InChar && *ArmorClass)
 	{
-		auto MyArmor = NewObject<UStrategyAttachment>(InChar, *ArmorClass);
+		UStrategyAttachment* MyArmor = InChar->TakePooledAttachment(ArmorClass);
+		if (MyArmor == nullptr)
+		{
+			MyArmor = NewObject<UStrategyAttachment>(InChar, *ArmorClass);
+		}
 		InChar->SetArmorAttachment(MyArmor);
 	}
 }
@@ -4,8 +4,12 @@
 #include "StrategyBuilding.h"
 #include "StrategySpectatorPawn.h"
 #include "StrategyTeamInterface.h"
+#include "AudioDevice.h"
 
 const FString AStrategyGameMode::DifficultyOptionName(TEXT("Difficulty"));
+const FString AStrategyGameMode::SeedOptionName(TEXT("Seed"));
+const FString AStrategyGameMode::FastForwardOptionName(TEXT("FastForward"));
+const FString AStrategyGameMode::TeamsOptionName(TEXT("Teams"));
 
 AStrategyGameMode::AStrategyGameMode(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -19,6 +23,10 @@ AStrategyGameMode::AStrategyGameMode(const FObjectInitializer& ObjectInitializer
 	HUDClass              = AStrategyHUD::StaticClass();
 	EmptyWallSlotClass    = EmptyWallSlotHelper.Class;
 
+	FastForwardStartTime     = 0.0f;
+	FastForwardStartRealTime = 0.0;
+	SavedVSync               = 0;
+
 	if ((GEngine != nullptr) && (GEngine->GameViewport != nullptr))
 	{
 		GEngine->GameViewport->SetSuppressTransitionMessage(true);
@@ -39,10 +47,110 @@ void AStrategyGameMode::InitGameState()
 	{
 		EGameDifficulty::Type const NewDifficulty = (EGameDifficulty::Type) UGameplayStatics::GetIntOption(OptionsString, DifficultyOptionName, 0);
 		StrategyGameState->SetGameDifficulty(NewDifficulty);
+
+		const int32 Seed = UGameplayStatics::HasOption(OptionsString, SeedOptionName) ? UGameplayStatics::GetIntOption(OptionsString, SeedOptionName, 0) : FMath::Rand();
+		StrategyGameState->InitMatchSeed(Seed);
+		UE_LOG(LogGame, Log, TEXT("Match seed: %d"), Seed);
+
+		StrategyGameState->InitTeams(UGameplayStatics::GetIntOption(OptionsString, TeamsOptionName, StrategyGameState->NumTeams));
+
 		StrategyGameState->StartGameplayStateMachine();
 	}
 }
 
+void AStrategyGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	if (UGameplayStatics::HasOption(OptionsString, FastForwardOptionName))
+	{
+		const FString StepOption = UGameplayStatics::ParseOption(OptionsString, FastForwardOptionName);
+		const float TimeStep = StepOption.IsEmpty() ? (1.0f / 30.0f) : FCString::Atof(*StepOption);
+		StartFastForward(FMath::Max(TimeStep, KINDA_SMALL_NUMBER));
+	}
+}
+
+void AStrategyGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopFastForward();
+	Super::EndPlay(EndPlayReason);
+}
+
+void AStrategyGameMode::StartFastForward(float TimeStep)
+{
+	AStrategyGameState* const StrategyGameState = GetGameState<AStrategyGameState>();
+	if (StrategyGameState == nullptr || StrategyGameState->bFastForward)
+	{
+		return;
+	}
+
+	// engine doesn't wait for wall clock with fixed time step, every frame advances game time by exactly one step
+	StrategyGameState->bFastForward = true;
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(TimeStep);
+
+	// nobody is watching, skip rendering and audio
+	UGameViewportClient* const Viewport = GetWorld()->GetGameViewport();
+	if (Viewport != nullptr)
+	{
+		Viewport->bDisableWorldRendering = true;
+	}
+
+	FAudioDeviceHandle AudioDevice = GetWorld()->GetAudioDevice();
+	if (AudioDevice)
+	{
+		AudioDevice->SetTransientPrimaryVolume(0.0f);
+	}
+
+	IConsoleVariable* const VSyncCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("r.VSync"));
+	if (VSyncCVar != nullptr)
+	{
+		SavedVSync = VSyncCVar->GetInt();
+		VSyncCVar->Set(0, ECVF_SetByCode);
+	}
+
+	FastForwardStartTime     = GetWorld()->GetTimeSeconds();
+	FastForwardStartRealTime = FPlatformTime::Seconds();
+	UE_LOG(LogGame, Log, TEXT("Fast forward started, step %.4f s"), TimeStep);
+}
+
+void AStrategyGameMode::StopFastForward()
+{
+	AStrategyGameState* const StrategyGameState = GetGameState<AStrategyGameState>();
+	if (StrategyGameState == nullptr || !StrategyGameState->bFastForward)
+	{
+		return;
+	}
+
+	StrategyGameState->bFastForward = false;
+	FApp::SetUseFixedTimeStep(false);
+
+	UGameViewportClient* const Viewport = GetWorld()->GetGameViewport();
+	if (Viewport != nullptr)
+	{
+		Viewport->bDisableWorldRendering = false;
+	}
+
+	FAudioDeviceHandle AudioDevice = GetWorld()->GetAudioDevice();
+	if (AudioDevice)
+	{
+		AudioDevice->SetTransientPrimaryVolume(1.0f);
+	}
+
+	IConsoleVariable* const VSyncCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("r.VSync"));
+	if (VSyncCVar != nullptr)
+	{
+		VSyncCVar->Set(SavedVSync, ECVF_SetByCode);
+	}
+}
+
+void AStrategyGameMode::ReportFastForward() const
+{
+	const float SimTime    = GetWorld()->GetTimeSeconds() - FastForwardStartTime;
+	const double RealTime  = FPlatformTime::Seconds() - FastForwardStartRealTime;
+	UE_LOG(LogGame, Display, TEXT("Fast forward: %.1f s simulated in %.1f s real time, speedup %.1fx"), SimTime, RealTime, RealTime > 0.0 ? SimTime / RealTime : 0.0);
+}
+
 void AStrategyGameMode::RestartPlayer(AController* NewPlayer)
 {
 	AActor* const StartSpot = FindPlayerStart(NewPlayer);
@@ -106,6 +214,11 @@ void AStrategyGameMode::FinishGame(EStrategyTeam::Type InWinningTeam)
 		// tell the gamestate to wrap it up
 		CurrentGameState->FinishGame(InWinningTeam);
 
+		if (CurrentGameState->bFastForward)
+		{
+			ReportFastForward();
+		}
+
 	}
 	// Add a timer to return to main if one does not already exist.
 	if (GetWorldTimerManager().GetTimerRate(TimerHandle_ReturnToMenu) == -1.0f )
@@ -122,30 +235,27 @@ void AStrategyGameMode::ReturnToMenu()
 
 bool AStrategyGameMode::OnFriendlyTeam(const AActor* ActorA, const AActor* ActorB)
 {
-	const IStrategyTeamInterface* TeamA = Cast<const IStrategyTeamInterface>(ActorA);
-	const IStrategyTeamInterface* TeamB = Cast<const IStrategyTeamInterface>(ActorB);
-	if((TeamA != nullptr && TeamA->GetTeamNum() == EStrategyTeam::Unknown) || (TeamB != nullptr && TeamB->GetTeamNum() == EStrategyTeam::Unknown))
-		return true;
-
-	return (TeamA != nullptr) && (TeamB != nullptr) && (TeamA->GetTeamNum() == TeamB->GetTeamNum());
+	return GetTeamRelation(ActorA, ActorB) == EStrategyTeamRelation::Friendly;
 }
 
 bool AStrategyGameMode::OnEnemyTeam(const AActor* ActorA, const AActor* ActorB)
 {
-	const IStrategyTeamInterface* TeamA = Cast<const IStrategyTeamInterface>(ActorA);
-	const IStrategyTeamInterface* TeamB = Cast<const IStrategyTeamInterface>(ActorB);
-	if( (TeamA != nullptr && TeamA->GetTeamNum() == EStrategyTeam::Unknown) || (TeamB != nullptr && TeamB->GetTeamNum() == EStrategyTeam::Unknown))
-		return false;
+	return GetTeamRelation(ActorA, ActorB) == EStrategyTeamRelation::Enemy;
+}
+
+EStrategyTeamRelation::Type AStrategyGameMode::GetTeamRelation(const AActor* ActorA, const AActor* ActorB)
+{
+	const UWorld* const World = (ActorA != nullptr && UStrategyTeamRegistry::IsEnabled()) ? ActorA->GetWorld() : nullptr;
+	const UStrategyTeamRegistry* const TeamRegistry = World != nullptr ? World->GetSubsystem<UStrategyTeamRegistry>() : nullptr;
 
-	return (TeamA != nullptr) && (TeamB != nullptr) && (TeamA->GetTeamNum() != TeamB->GetTeamNum());
+	return TeamRegistry != nullptr ? TeamRegistry->GetRelation(ActorA, ActorB) : UStrategyTeamRegistry::GetRelationByInterface(ActorA, ActorB);
 }
 
 void AStrategyGameMode::ExitGame()
 {
-	AStrategyPlayerController* PlayerController = nullptr;
-	if (GEngine)
+	APlayerController* const PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController != nullptr)
 	{
-		PlayerController = Cast<AStrategyPlayerController>(GEngine->GetFirstLocalPlayerController(GetWorld()));
 		PlayerController->ConsoleCommand(TEXT("quit"));
 	}
 }
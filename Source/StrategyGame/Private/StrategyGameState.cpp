@@ -7,21 +7,27 @@
 AStrategyGameState::AStrategyGameState(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	// team data for: unknown, player, enemy
-	PlayersData.AddZeroed(EStrategyTeam::MAX);
+	// team data for: unknown, player, enemy, resized by InitTeams for matches with more teams
+	NumTeams = EStrategyTeam::MAX;
+	PlayersData.AddZeroed(NumTeams);
+	LivePawnCounter.AddZeroed(NumTeams);
 	GameFinishedTime = 0;
 	MiniMapCamera    = nullptr;
 	WinningTeam      = EStrategyTeam::Unknown;
+	CameraFocalLocation = FVector::ZeroVector;
+	bHasCameraFocalLocation = false;
+	bFastForward = false;
+	MatchSeed = 0;
 }
 
 int32 AStrategyGameState::GetNumberOfLivePawns(TEnumAsByte<EStrategyTeam::Type> InTeam) const
 {
-	return LivePawnCounter[InTeam];
+	return LivePawnCounter.IsValidIndex(InTeam) ? LivePawnCounter[InTeam] : 0;
 }
 
 void AStrategyGameState::AddChar(AStrategyChar* InChar)
 {
-	if (InChar != nullptr)
+	if (InChar != nullptr && LivePawnCounter.IsValidIndex(InChar->GetTeamNum()))
 	{
 		LivePawnCounter[InChar->GetTeamNum()]++;
 	}
@@ -29,7 +35,7 @@ void AStrategyGameState::AddChar(AStrategyChar* InChar)
 
 void AStrategyGameState::RemoveChar(AStrategyChar* InChar)
 {
-	if (InChar != nullptr)
+	if (InChar != nullptr && LivePawnCounter.IsValidIndex(InChar->GetTeamNum()))
 	{
 		LivePawnCounter[InChar->GetTeamNum()]--;
 	}
@@ -37,23 +43,33 @@ void AStrategyGameState::RemoveChar(AStrategyChar* InChar)
 
 void AStrategyGameState::OnCharDied(AStrategyChar* InChar)
 {
-	if (InChar && (InChar->GetTeamNum() == EStrategyTeam::Enemy))
+	if (InChar)
 	{
-		PlayersData[EStrategyTeam::Player].ResourcesAvailable += InChar->ResourcesToGather;		
+		// deaths of every team are counted, only enemy deaths pay player
+		if (InChar->GetTeamNum() == EStrategyTeam::Enemy)
+		{
+			PlayersData[EStrategyTeam::Player].ResourcesAvailable += InChar->ResourcesToGather;
+		}
 		RemoveChar(InChar);
 	}
 }
 
-void AStrategyGameState::OnActorDamaged(AActor* InActor, float Damage, AController* EventInstigator)
+void AStrategyGameState::AddDamageDone(uint8 TeamNum, int32 Damage)
 {
-	IStrategyTeamInterface* const InstigatorTeam = Cast<IStrategyTeamInterface>(EventInstigator);
-
 	// track damage done
 	// @todo, this is def not the place for this
+	if (PlayersData.IsValidIndex(TeamNum))
+	{
+		PlayersData[TeamNum].DamageDone += Damage;
+	}
+}
+
+void AStrategyGameState::OnActorDamaged(AActor* InActor, float Damage, AController* EventInstigator)
+{
+	IStrategyTeamInterface* const InstigatorTeam = Cast<IStrategyTeamInterface>(EventInstigator);
 	if (InstigatorTeam)
 	{
-		FPlayerData& TeamData = PlayersData[InstigatorTeam->GetTeamNum()];
-		TeamData.DamageDone += FMath::TruncToInt(Damage);
+		AddDamageDone(InstigatorTeam->GetTeamNum(), FMath::TruncToInt(Damage));
 	}
 }
 
@@ -67,7 +83,7 @@ void AStrategyGameState::OnCharSpawned(AStrategyChar* InChar)
 
 FPlayerData* AStrategyGameState::GetPlayerData(uint8 TeamNum) const
 {
-	if (TeamNum != EStrategyTeam::Unknown)
+	if (TeamNum != EStrategyTeam::Unknown && PlayersData.IsValidIndex(TeamNum))
 	{
 		return &PlayersData[TeamNum];
 	}
@@ -75,6 +91,44 @@ FPlayerData* AStrategyGameState::GetPlayerData(uint8 TeamNum) const
 	return nullptr;
 }
 
+void AStrategyGameState::InitTeams(int32 InNumTeams)
+{
+	NumTeams = FMath::Clamp<int32>(InNumTeams, EStrategyTeam::MAX, UStrategyTeamRegistry::NoTeam - 1);
+	PlayersData.Reset();
+	PlayersData.AddZeroed(NumTeams);
+	LivePawnCounter.Reset();
+	LivePawnCounter.AddZeroed(NumTeams);
+
+	UStrategyTeamRegistry* const TeamRegistry = GetWorld()->GetSubsystem<UStrategyTeamRegistry>();
+	if (TeamRegistry != nullptr)
+	{
+		TeamRegistry->SetNumTeams(NumTeams);
+	}
+}
+
+int32 AStrategyGameState::GetNumTeams() const
+{
+	return NumTeams;
+}
+
+void AStrategyGameState::AddUnfinishedBuilding(AStrategyBuilding* InBuilding)
+{
+	if (InBuilding != nullptr)
+	{
+		UnfinishedBuildings.AddUnique(InBuilding);
+	}
+}
+
+void AStrategyGameState::RemoveUnfinishedBuilding(AStrategyBuilding* InBuilding)
+{
+	UnfinishedBuildings.RemoveSingleSwap(InBuilding);
+}
+
+const TArray<TWeakObjectPtr<AStrategyBuilding>>& AStrategyGameState::GetUnfinishedBuildings() const
+{
+	return UnfinishedBuildings;
+}
+
 void AStrategyGameState::SetGameplayState(EGameplayState::Type NewState)
 {
 	GameplayState = NewState;
@@ -105,6 +159,22 @@ float AStrategyGameState::GetRemainingWaitTime() const
 }
 
 
+void AStrategyGameState::InitMatchSeed(int32 Seed)
+{
+	MatchSeed = Seed;
+	CombatRandom.Initialize(Seed);
+}
+
+int32 AStrategyGameState::GetMatchSeed() const
+{
+	return MatchSeed;
+}
+
+FRandomStream& AStrategyGameState::GetCombatRandom()
+{
+	return CombatRandom;
+}
+
 EStrategyTeam::Type AStrategyGameState::GetWinningTeam() const
 {
 	return WinningTeam;
@@ -149,7 +219,7 @@ void AStrategyGameState::SetTimersPause(bool bIsPaused)
 }
 void AStrategyGameState::SetGamePaused(bool bIsPaused)
 {
-	AStrategyPlayerController* const MyPlayer = Cast<AStrategyPlayerController>(GEngine->GetFirstLocalPlayerController(GetWorld()));
+	AStrategyPlayerController* const MyPlayer = Cast<AStrategyPlayerController>(GetWorld()->GetFirstPlayerController());
 	if (MyPlayer != nullptr)
 	{
 		MyPlayer->SetPause(bIsPaused);
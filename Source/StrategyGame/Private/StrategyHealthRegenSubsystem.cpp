@@ -0,0 +1,159 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyHealthRegenSubsystem.h"
+#include "StrategyCombatSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Health regen"), STAT_StrategyHealthRegen, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Health regen updates"), STAT_StrategyHealthRegenUpdates, STATGROUP_StrategyAI);
+
+UStrategyHealthRegenSubsystem::UStrategyHealthRegenSubsystem()
+	: RegenInterval(1.0f)
+	, NextIndex(0)
+	, PendingUpdates(0.0f)
+{
+}
+
+void UStrategyHealthRegenSubsystem::Deinitialize()
+{
+	Chars.Empty();
+	HealthRegen.Empty();
+	MaxHealth.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UStrategyHealthRegenSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyHealthRegenSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyHealthRegenSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyHealthRegenSubsystem::RegisterChar(AStrategyChar* InChar)
+{
+	if (InChar == nullptr || InChar->HealthRegenIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	InChar->HealthRegenIndex = Chars.Add(InChar);
+	HealthRegen.Add(0);
+	MaxHealth.Add(0);
+	UpdateChar(InChar);
+}
+
+void UStrategyHealthRegenSubsystem::UnregisterChar(AStrategyChar* InChar)
+{
+	if (InChar == nullptr || !Chars.IsValidIndex(InChar->HealthRegenIndex) || Chars[InChar->HealthRegenIndex] != InChar)
+	{
+		return;
+	}
+
+	// character already updated in this round is first swapped with last updated one,
+	// so the character taking its index below is one not updated yet and stays at or after NextIndex
+	int32 Index = InChar->HealthRegenIndex;
+	if (Index < NextIndex)
+	{
+		NextIndex--;
+		SwapChars(Index, NextIndex);
+		Index = NextIndex;
+	}
+
+	// keep arrays dense, last character takes the free index
+	Chars.RemoveAtSwap(Index, 1, false);
+	HealthRegen.RemoveAtSwap(Index, 1, false);
+	MaxHealth.RemoveAtSwap(Index, 1, false);
+	if (Chars.IsValidIndex(Index))
+	{
+		Chars[Index]->HealthRegenIndex = Index;
+	}
+
+	InChar->HealthRegenIndex = INDEX_NONE;
+}
+
+void UStrategyHealthRegenSubsystem::SwapChars(int32 IndexA, int32 IndexB)
+{
+	if (IndexA != IndexB)
+	{
+		Chars.Swap(IndexA, IndexB);
+		HealthRegen.Swap(IndexA, IndexB);
+		MaxHealth.Swap(IndexA, IndexB);
+		Chars[IndexA]->HealthRegenIndex = IndexA;
+		Chars[IndexB]->HealthRegenIndex = IndexB;
+	}
+}
+
+void UStrategyHealthRegenSubsystem::UpdateChar(const AStrategyChar* InChar)
+{
+	if (InChar != nullptr && Chars.IsValidIndex(InChar->HealthRegenIndex) && Chars[InChar->HealthRegenIndex] == InChar)
+	{
+		HealthRegen[InChar->HealthRegenIndex] = InChar->ModifiedPawnData.HealthRegen;
+		MaxHealth[InChar->HealthRegenIndex] = InChar->GetMaxHealth();
+	}
+}
+
+int32 UStrategyHealthRegenSubsystem::GetNumChars() const
+{
+	return Chars.Num();
+}
+
+void UStrategyHealthRegenSubsystem::Tick(float DeltaTime)
+{
+	if (Chars.Num() == 0)
+	{
+		PendingUpdates = 0.0f;
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_StrategyHealthRegen);
+
+	// every character once per interval, long frames can't update anyone twice
+	PendingUpdates = FMath::Min(PendingUpdates + Chars.Num() * DeltaTime / RegenInterval, (float)Chars.Num());
+	const int32 NumUpdates = FMath::FloorToInt(PendingUpdates);
+	PendingUpdates -= NumUpdates;
+
+	if (NumUpdates > 0)
+	{
+		UpdateChars(NumUpdates);
+	}
+}
+
+void UStrategyHealthRegenSubsystem::UpdateChars(int32 NumUpdates)
+{
+	UStrategyCombatSubsystem* const Combat = GetWorld()->GetSubsystem<UStrategyCombatSubsystem>();
+	for (int32 Idx = 0; Idx < NumUpdates; Idx++)
+	{
+		if (NextIndex >= Chars.Num())
+		{
+			NextIndex = 0;
+		}
+
+		const int32 Index = NextIndex++;
+		const int32 Regen = HealthRegen[Index];
+		if (Regen == 0)
+		{
+			continue;
+		}
+
+		AStrategyChar* const TestChar = Chars[Index];
+		if (Regen < 0)
+		{
+			// negative health regen is a DoT, applied with all other damage of this frame;
+			// character is its own instigator as it always was, so friendly fire rule cancels it
+			if (Combat)
+			{
+				Combat->QueueDamage(TestChar, -Regen, FDamageEvent(UDamageType::StaticClass()), TestChar->GetController(), TestChar);
+			}
+		}
+		else if (TestChar->Health > 0.f)
+		{
+			TestChar->Health = FMath::Min<int32>(TestChar->Health + Regen, MaxHealth[Index]);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_StrategyHealthRegenUpdates, NumUpdates);
+}
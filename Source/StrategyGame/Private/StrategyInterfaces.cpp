@@ -4,6 +4,7 @@
 #include "StrategyInputInterface.h"
 #include "StrategyTeamInterface.h"
 #include "StrategySelectionInterface.h"
+#include "StrategyPoolableInterface.h"
 
 UStrategyInputInterface::UStrategyInputInterface(const FObjectInitializer& ObjectInitializer) 
     : Super(ObjectInitializer) 
@@ -20,3 +21,7 @@ UStrategySelectionInterface::UStrategySelectionInterface(const FObjectInitialize
 {
 }
 
+UStrategyPoolableInterface::UStrategyPoolableInterface(const FObjectInitializer& ObjectInitializer) 
+    : Super(ObjectInitializer) 
+{
+}
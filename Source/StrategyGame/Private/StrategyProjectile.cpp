@@ -2,11 +2,14 @@
 
 #include "StrategyGame.h"
 #include "StrategyProjectile.h"
+#include "StrategyActorPoolSubsystem.h"
+#include "StrategyProjectileSubsystem.h"
 
 AStrategyProjectile::AStrategyProjectile(const FObjectInitializer& ObjectInitializer) 
 	: Super(ObjectInitializer), Building(NULL), ConstantDamage(false)
 {
 	bInitialized  = false;
+	SimIndex      = INDEX_NONE;
 	DamageType    = UDamageType::StaticClass();
 
 	PrimaryActorTick.bCanEverTick = true;
@@ -30,39 +33,73 @@ AStrategyProjectile::AStrategyProjectile(const FObjectInitializer& ObjectInitial
 	MovementComp->ProjectileGravityScale = 0.0f;
 }
 
+void AStrategyProjectile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// bound once, projectile keeps it through all its lives in pool
+	MovementComp->OnProjectileStop.AddUniqueDynamic(this, &AStrategyProjectile::OnHit);
+}
+
 void AStrategyProjectile::InitProjectile(const FVector& Direction, uint8 InTeamNum, int32 ImpactDamage, float InLifeSpan)
 {
-	MovementComp->OnProjectileStop.AddDynamic(this, &AStrategyProjectile::OnHit);
 	MovementComp->Velocity = MovementComp->InitialSpeed * Direction;
 	
 	MyTeamNum       = InTeamNum;
 	RemainingDamage = ImpactDamage;
+	HitActorIds.Reset();
+
+	// replaces InitialLifeSpan of freshly spawned projectile
 	SetLifeSpan(InLifeSpan);
 
 	bInitialized    = true;
+
+	UStrategyProjectileSubsystem* const Sim = GetWorld()->GetSubsystem<UStrategyProjectileSubsystem>();
+	if (Sim && UStrategyProjectileSubsystem::IsEnabled())
+	{
+		Sim->AddProjectile(this);
+	}
+}
+
+void AStrategyProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UStrategyProjectileSubsystem* const Sim = GetWorld()->GetSubsystem<UStrategyProjectileSubsystem>();
+	if (Sim)
+	{
+		Sim->RemoveProjectile(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AStrategyProjectile::NotifyActorBeginOverlap(class AActor* OtherActor)
 {
 	Super::NotifyActorBeginOverlap(OtherActor);
 
-	if (!bInitialized)
+	// simulated projectiles find their victims in spatial grid
+	if (!bInitialized || SimIndex != INDEX_NONE)
 	{
 		return;
 	}
 
-	if (HitActors.Find(OtherActor) != INDEX_NONE)
+	AStrategyChar* OtherChar = Cast<AStrategyChar>(OtherActor);
+	if (OtherChar && OtherChar->GetTeamNum() > EStrategyTeam::Unknown && OtherChar->GetTeamNum() != GetTeamNum())
 	{
-		return;
+		HitChar(OtherChar, GetActorLocation(), MovementComp->Velocity.GetSafeNormal());
 	}
+}
 
-	HitActors.AddUnique(OtherActor);
-	AStrategyChar* HitChar = Cast<AStrategyChar>(OtherActor);
-	if (HitChar && HitChar->GetTeamNum() > EStrategyTeam::Unknown && HitChar->GetTeamNum() != GetTeamNum())
+void AStrategyProjectile::HitChar(AStrategyChar* InChar, const FVector& HitLocation, const FVector& HitDir)
+{
+	bool bAlreadyHit = false;
+	HitActorIds.Add(InChar->GetUniqueID(), &bAlreadyHit);
+	if (bAlreadyHit)
 	{
-        FHitResult PawnHit(HitChar, HitChar->GetCapsuleComponent(), GetActorLocation(), MovementComp->Velocity.GetSafeNormal());
-		OnHit(PawnHit);
+		return;
 	}
+
+	FHitResult PawnHit(InChar, InChar->GetCapsuleComponent(), HitLocation, HitDir);
+	OnHit(PawnHit);
 }
 
 void AStrategyProjectile::OnHit(FHitResult const& HitResult)
@@ -70,30 +107,90 @@ void AStrategyProjectile::OnHit(FHitResult const& HitResult)
 	DealDamage(HitResult);
 	OnProjectileHit(HitResult.GetActor(), HitResult.ImpactPoint, HitResult.ImpactNormal);
 
-	if (RemainingDamage <= 0)
+	// blueprint may have returned projectile to pool already
+	if (bInitialized && RemainingDamage <= 0)
+	{
+		DeactivateProjectile();
+	}
+}
+
+void AStrategyProjectile::DeactivateProjectile()
+{
+	const bool bWasActive = bInitialized;
+	OnProjectileDestroyed();
+
+	// blueprint event may have pooled or destroyed projectile already
+	if (IsPendingKillPending() || (bWasActive && !bInitialized))
+	{
+		return;
+	}
+
+	if (!ReleaseToPool())
 	{
-		OnProjectileDestroyed();
 		Destroy();
 	}
 }
 
-void AStrategyProjectile::DealDamage(FHitResult const& HitResult)
+bool AStrategyProjectile::ReleaseToPool()
 {
-	const AStrategyChar* HitChar = Cast<AStrategyChar>(HitResult.GetActor());
-	const float PrevHealth = HitChar ? HitChar->Health : 0.0f;
+	UStrategyActorPoolSubsystem* const Pool = GetWorld()->GetSubsystem<UStrategyActorPoolSubsystem>();
+	return bInitialized && Pool != nullptr && Pool->ReleaseActor(this);
+}
 
-	UGameplayStatics::ApplyPointDamage(HitResult.GetActor(), RemainingDamage, -HitResult.ImpactNormal, HitResult, NULL, this, UDamageType::StaticClass());
-	if (HitChar && !ConstantDamage)
+void AStrategyProjectile::K2_DestroyActor()
+{
+	if (!ReleaseToPool())
 	{
-		RemainingDamage -= FMath::TruncToInt(PrevHealth - HitChar->Health);
+		Super::K2_DestroyActor();
 	}
 }
 
-void AStrategyProjectile::LifeSpanExpired()
+void AStrategyProjectile::OnPooled()
 {
-	OnProjectileDestroyed();
+	UStrategyProjectileSubsystem* const Sim = GetWorld()->GetSubsystem<UStrategyProjectileSubsystem>();
+	if (Sim)
+	{
+		Sim->RemoveProjectile(this);
+	}
+
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	SetLifeSpan(0.0f);
+
+	MovementComp->StopMovementImmediately();
+	MovementComp->SetComponentTickEnabled(false);
+
+	Building        = nullptr;
+	RemainingDamage = 0;
+	HitActorIds.Reset();
+	bInitialized    = false;
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+void AStrategyProjectile::OnUnpooled()
+{
+	// movement component lets go of updated component when it stops on hit
+	MovementComp->SetUpdatedComponent(CollisionComp);
+	MovementComp->SetComponentTickEnabled(true);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+}
 
-	Super::LifeSpanExpired();
+void AStrategyProjectile::DealDamage(FHitResult const& HitResult)
+{
+	// characters report damage taken by their health, other actors don't use up projectile
+	const float DamageTaken = UGameplayStatics::ApplyPointDamage(HitResult.GetActor(), RemainingDamage, -HitResult.ImpactNormal, HitResult, NULL, this, UDamageType::StaticClass());
+	if (!ConstantDamage && Cast<AStrategyChar>(HitResult.GetActor()))
+	{
+		RemainingDamage -= FMath::TruncToInt(DamageTaken);
+	}
+}
+
+void AStrategyProjectile::LifeSpanExpired()
+{
+	DeactivateProjectile();
 }
 
 uint8 AStrategyProjectile::GetTeamNum() const
@@ -104,13 +201,8 @@ uint8 AStrategyProjectile::GetTeamNum() const
 void AStrategyProjectile::FellOutOfWorld(const UDamageType& dmgType)
 {
 	// If we fall out of the world we need to follow the same chain of events as if we hit something. 
-    // BUT the blueprint destroys us so we dont wanna do that instead turn off what we need too and call the destroyed event and let the blueprint do what it needs to.
-	// (This isn't an ideal way of doing this !)
 	DisableComponentsSimulatePhysics();
-	SetActorHiddenInGame(true);
-	SetActorEnableCollision(false);
-	OnProjectileDestroyed();
-	SetLifeSpan(0.0f);
+	DeactivateProjectile();
 }
 
 void AStrategyProjectile::PostLoad()
@@ -0,0 +1,293 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyProjectileSubsystem.h"
+#include "StrategyProjectile.h"
+#include "StrategySpatialGrid.h"
+#include "StrategySimProfiler.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile simulation"), STAT_StrategyProjectileSim, STATGROUP_StrategyAI);
+DECLARE_CYCLE_STAT(TEXT("Projectile actor moves"), STAT_StrategyProjectileActorMoves, STATGROUP_StrategyAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated projectiles"), STAT_StrategySimulatedProjectiles, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile traces (async)"), STAT_StrategyProjectileTracesAsync, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile traces (sync)"), STAT_StrategyProjectileTracesSync, STATGROUP_StrategyAI);
+
+static TAutoConsoleVariable<int32> CVarProjectileSimEnabled(TEXT("Strategy.Projectiles.Simulate"), 1, TEXT("If set, projectiles are moved by projectile subsystem instead of their movement components."));
+static TAutoConsoleVariable<int32> CVarProjectileMoveActors(TEXT("Strategy.Projectiles.MoveActors"), 1, TEXT("If set, simulated projectile actors follow their simulated location every frame. If not, they are only moved to where they hit or stop being simulated, for runs where nobody watches their visuals."));
+
+/** predicted trace is longer than last frame's movement, so small frame time changes don't need sync trace */
+static const float TracePredictionScale = 1.5f;
+
+/** grid query around projectile path is grown by this, to include capsules of characters centered further away */
+static const float MaxTargetRadius = 100.0f;
+
+UStrategyProjectileSubsystem::UStrategyProjectileSubsystem()
+	: NumRemoved(0)
+	, LastDeltaTime(0.0f)
+{
+}
+
+void UStrategyProjectileSubsystem::Deinitialize()
+{
+	Projectiles.Empty();
+	Locations.Empty();
+	Velocities.Empty();
+	Teams.Empty();
+	TraceHandles.Empty();
+	TraceLengths.Empty();
+	PrevLocations.Empty();
+	NumRemoved = 0;
+
+	Super::Deinitialize();
+}
+
+bool UStrategyProjectileSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyProjectileSubsystem, STATGROUP_Tickables);
+}
+
+bool UStrategyProjectileSubsystem::IsEnabled()
+{
+	return CVarProjectileSimEnabled.GetValueOnGameThread() != 0;
+}
+
+void UStrategyProjectileSubsystem::AddProjectile(AStrategyProjectile* Projectile)
+{
+	if (Projectile == nullptr || Projectile->SimIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	UProjectileMovementComponent* const MovementComp = Projectile->GetMovementComp();
+	MovementComp->SetComponentTickEnabled(false);
+
+	// hits are found by subsystem, moving actor doesn't need to update overlaps
+	Projectile->GetCollisionComp()->SetGenerateOverlapEvents(false);
+
+	const int32 Slot = Projectiles.Add(Projectile);
+	Locations.Add(Projectile->GetActorLocation());
+	Velocities.Add(MovementComp->Velocity);
+	Teams.Add(Projectile->GetTeamNum());
+	TraceHandles.Add(FTraceHandle());
+	TraceLengths.Add(0.0f);
+	Projectile->SimIndex = Slot;
+
+	// first frame needs sync trace, unless we already know how long frames are
+	if (LastDeltaTime > 0.0f)
+	{
+		RequestTrace(Slot);
+	}
+
+	INC_DWORD_STAT(STAT_StrategySimulatedProjectiles);
+}
+
+void UStrategyProjectileSubsystem::RemoveProjectile(AStrategyProjectile* Projectile)
+{
+	if (Projectile == nullptr || !Projectiles.IsValidIndex(Projectile->SimIndex) || Projectiles[Projectile->SimIndex] != Projectile)
+	{
+		return;
+	}
+
+	// actors left behind by simulation are placed where it ended
+	if (CVarProjectileMoveActors.GetValueOnGameThread() == 0)
+	{
+		Projectile->SetActorLocation(Locations[Projectile->SimIndex], false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	// projectiles can be removed by their own hit events, slot is freed in next compaction
+	Projectiles[Projectile->SimIndex] = nullptr;
+	Projectile->SimIndex = INDEX_NONE;
+	Projectile->GetCollisionComp()->SetGenerateOverlapEvents(true);
+	NumRemoved++;
+
+	DEC_DWORD_STAT(STAT_StrategySimulatedProjectiles);
+}
+
+int32 UStrategyProjectileSubsystem::GetNumProjectiles() const
+{
+	return Projectiles.Num() - NumRemoved;
+}
+
+void UStrategyProjectileSubsystem::Compact()
+{
+	for (int32 Slot = Projectiles.Num() - 1; Slot >= 0 && NumRemoved > 0; Slot--)
+	{
+		if (Projectiles[Slot] != nullptr)
+		{
+			continue;
+		}
+
+		Projectiles.RemoveAtSwap(Slot, 1, false);
+		Locations.RemoveAtSwap(Slot, 1, false);
+		Velocities.RemoveAtSwap(Slot, 1, false);
+		Teams.RemoveAtSwap(Slot, 1, false);
+		TraceHandles.RemoveAtSwap(Slot, 1, false);
+		TraceLengths.RemoveAtSwap(Slot, 1, false);
+		if (Projectiles.IsValidIndex(Slot))
+		{
+			Projectiles[Slot]->SimIndex = Slot;
+		}
+		NumRemoved--;
+	}
+}
+
+void UStrategyProjectileSubsystem::Tick(float DeltaTime)
+{
+	Compact();
+	if (Projectiles.Num() == 0)
+	{
+		LastDeltaTime = DeltaTime;
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_StrategyProjectileSim);
+	STRATEGY_SIM_PROFILE_SCOPE(GetWorld(), EStrategySimStat::Projectiles);
+
+	// flight is linear, advance everything in one pass
+	const int32 NumProjectiles = Projectiles.Num();
+	PrevLocations = Locations;
+	FVector* const RESTRICT LocationData = Locations.GetData();
+	const FVector* const RESTRICT VelocityData = Velocities.GetData();
+	for (int32 Slot = 0; Slot < NumProjectiles; Slot++)
+	{
+		LocationData[Slot] += VelocityData[Slot] * DeltaTime;
+	}
+
+	// hits can remove projectiles and spawn new ones, those are handled next frame
+	LastDeltaTime = DeltaTime;
+	const bool bMoveActors = CVarProjectileMoveActors.GetValueOnGameThread() != 0;
+	for (int32 Slot = 0; Slot < NumProjectiles; Slot++)
+	{
+		if (Projectiles[Slot] != nullptr)
+		{
+			UpdateProjectile(Slot, bMoveActors);
+		}
+	}
+}
+
+void UStrategyProjectileSubsystem::UpdateProjectile(int32 Slot, bool bMoveActor)
+{
+	AStrategyProjectile* const Projectile = Projectiles[Slot];
+	const FVector Start = PrevLocations[Slot];
+	const FVector Delta = Locations[Slot] - Start;
+	const float PathLength = Delta.Size();
+	const FVector Dir = PathLength > KINDA_SMALL_NUMBER ? Delta / PathLength : Velocities[Slot].GetSafeNormal();
+
+	FHitResult StaticHit;
+	const bool bStaticHit = FindStaticHit(Slot, StaticHit);
+	const float MaxDistance = bStaticHit ? StaticHit.Distance : PathLength;
+
+	// characters along path, ordered by distance
+	TArray<TPair<float, AStrategyChar*>, TInlineAllocator<8>> CharHits;
+	const UStrategySpatialGrid* const Grid = GetWorld()->GetSubsystem<UStrategySpatialGrid>();
+	if (Grid != nullptr)
+	{
+		const uint8 TeamNum = Teams[Slot];
+		const float SphereRadius = Projectile->GetCollisionComp()->GetScaledSphereRadius();
+		Grid->ForEachCharInRadius(Start + Delta * 0.5f, PathLength * 0.5f + MaxTargetRadius, [&](AStrategyChar* TestChar)
+		{
+			const uint8 CharTeam = TestChar->GetTeamNum();
+			if (CharTeam <= EStrategyTeam::Unknown || CharTeam == TeamNum)
+			{
+				return;
+			}
+
+			const UCapsuleComponent* const Capsule = TestChar->GetCapsuleComponent();
+			const float Radius = (Capsule ? Capsule->GetScaledCapsuleRadius() : 0.0f) + SphereRadius;
+			const float HalfHeight = (Capsule ? Capsule->GetScaledCapsuleHalfHeight() : 0.0f) + SphereRadius;
+
+			const FVector ToChar = TestChar->GetActorLocation() - Start;
+			const float Distance = FMath::Clamp(FVector::DotProduct(ToChar, Dir), 0.0f, PathLength);
+			const FVector Offset = ToChar - Dir * Distance;
+			if (Distance <= MaxDistance && Offset.SizeSquared2D() <= FMath::Square(Radius) && FMath::Abs(Offset.Z) <= HalfHeight)
+			{
+				CharHits.Add(TPair<float, AStrategyChar*>(Distance, TestChar));
+			}
+		});
+	}
+
+	if (CharHits.Num() > 1)
+	{
+		CharHits.Sort([](const TPair<float, AStrategyChar*>& A, const TPair<float, AStrategyChar*>& B) { return A.Key < B.Key; });
+	}
+
+	for (const TPair<float, AStrategyChar*>& CharHit : CharHits)
+	{
+		// hit effects are played at actor
+		if (!bMoveActor)
+		{
+			Projectile->SetActorLocation(Start + Dir * CharHit.Key, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+
+		Projectile->HitChar(CharHit.Value, Start + Dir * CharHit.Key, Dir);
+		if (Projectile->SimIndex != Slot)
+		{
+			// projectile is spent
+			return;
+		}
+	}
+
+	if (bStaticHit)
+	{
+		// stop at static geometry, projectile stays there until its blueprint or lifespan removes it
+		RemoveProjectile(Projectile);
+		Projectile->SetActorLocation(StaticHit.Location);
+		Projectile->OnHit(StaticHit);
+		return;
+	}
+
+	// actor follows, its blueprint effects and attached components are placed by it
+	if (bMoveActor)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_StrategyProjectileActorMoves);
+		Projectile->SetActorLocation(Locations[Slot], false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	RequestTrace(Slot);
+}
+
+bool UStrategyProjectileSubsystem::FindStaticHit(int32 Slot, FHitResult& OutHit) const
+{
+	const FVector Start = PrevLocations[Slot];
+	const FVector End = Locations[Slot];
+	const float PathLength = FVector::Dist(Start, End);
+
+	// trace requested last frame covers this frame's path, unless frame took much longer
+	FTraceDatum TraceData;
+	if (PathLength <= TraceLengths[Slot] && GetWorld()->QueryTraceData(TraceHandles[Slot], TraceData))
+	{
+		for (const FHitResult& Hit : TraceData.OutHits)
+		{
+			if (Hit.bBlockingHit && Hit.Distance <= PathLength)
+			{
+				OutHit = Hit;
+				OutHit.TraceEnd = End;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_StrategyProjectileTracesSync);
+
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ProjectileTrace), false, Projectiles[Slot]);
+	return GetWorld()->LineTraceSingleByObjectType(OutHit, Start, End, FCollisionObjectQueryParams(ECC_WorldStatic), TraceParams);
+}
+
+void UStrategyProjectileSubsystem::RequestTrace(int32 Slot)
+{
+	const float TraceLength = Velocities[Slot].Size() * LastDeltaTime * TracePredictionScale;
+	const FVector Start = Locations[Slot];
+	const FVector End = Start + Velocities[Slot].GetSafeNormal() * TraceLength;
+
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ProjectileTrace), false, Projectiles[Slot]);
+	TraceHandles[Slot] = GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, Start, End, FCollisionObjectQueryParams(ECC_WorldStatic), TraceParams);
+	TraceLengths[Slot] = TraceLength;
+
+	INC_DWORD_STAT(STAT_StrategyProjectileTracesAsync);
+}
@@ -0,0 +1,426 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategySimBenchmarkCommandlet.h"
+#include "StrategySimProfiler.h"
+#include "StrategyBuilding_Brewery.h"
+#include "StrategyAIDirector.h"
+#include "StrategyFlowFieldSubsystem.h"
+#include "GameMapsSettings.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Misc/PackagePath.h"
+#include "UObject/LinkerInstancingContext.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogStrategySimBenchmark, Log, All);
+
+UStrategySimBenchmarkCommandlet::UStrategySimBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = true;
+	LogToConsole = true;
+}
+
+UWorld* UStrategySimBenchmarkCommandlet::LoadWorld(const FString& MapName, int32 Seed, int32 Index)
+{
+	// loading same package again would give back the same world, so every match gets its own instance of map package
+	const FString InstanceName = FString::Printf(TEXT("%s_SimWorld%d"), *MapName, Index);
+	FPackagePath PackagePath;
+	if (!FPackagePath::TryFromPackageName(MapName, PackagePath))
+	{
+		UE_LOG(LogStrategySimBenchmark, Error, TEXT("Invalid map name %s"), *MapName);
+		return nullptr;
+	}
+
+	FLinkerInstancingContext InstancingContext;
+	InstancingContext.AddPackageMapping(FName(*MapName), FName(*InstanceName));
+	const int32 RequestId = LoadPackageAsync(PackagePath, FName(*InstanceName), FLoadPackageAsyncDelegate(), PKG_None, INDEX_NONE, 0, &InstancingContext);
+	FlushAsyncLoading(RequestId);
+	if (FindPackage(nullptr, *InstanceName) == nullptr)
+	{
+		UE_LOG(LogStrategySimBenchmark, Error, TEXT("Failed to load %s as %s"), *MapName, *InstanceName);
+		return nullptr;
+	}
+
+	UClass* GameInstanceClass = GetDefault<UGameMapsSettings>()->GameInstanceClass.TryLoadClass<UGameInstance>();
+	if (GameInstanceClass == nullptr)
+	{
+		GameInstanceClass = UGameInstance::StaticClass();
+	}
+
+	UGameInstance* const GameInstance = NewObject<UGameInstance>(GEngine, GameInstanceClass);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone();
+
+	// map package is in memory already, LoadMap finds it by its instance name
+	const FString URLString = FString::Printf(TEXT("%s?%s=%d"), *InstanceName, *AStrategyGameMode::SeedOptionName, Seed);
+	FURL URL(nullptr, *URLString, TRAVEL_Absolute);
+
+	FString Error;
+	FWorldContext* const WorldContext = GameInstance->GetWorldContext();
+	if (WorldContext == nullptr || !GEngine->LoadMap(*WorldContext, URL, nullptr, Error))
+	{
+		UE_LOG(LogStrategySimBenchmark, Error, TEXT("Failed to load %s: %s"), *URLString, *Error);
+		GameInstance->RemoveFromRoot();
+		return nullptr;
+	}
+
+	return WorldContext->World();
+}
+
+void UStrategySimBenchmarkCommandlet::UnloadWorld(UWorld* World)
+{
+	UGameInstance* const GameInstance = World->GetGameInstance();
+	World->EndPlay(EEndPlayReason::Quit);
+	World->CleanupWorld();
+
+	if (GameInstance != nullptr)
+	{
+		GEngine->DestroyWorldContext(World);
+		GameInstance->Shutdown();
+		GameInstance->RemoveFromRoot();
+	}
+}
+
+void UStrategySimBenchmarkCommandlet::SpawnWave(UWorld* World, const FWaveSchedule& Schedule, int32 WaveIdx)
+{
+	const int32 NumMinions = Schedule.Size + Schedule.Growth * WaveIdx;
+	for (TActorIterator<AStrategyBuilding_Brewery> It(World); It; ++It)
+	{
+		UStrategyAIDirector* const AIDirector = It->GetAIDirector();
+		if (AIDirector != nullptr && It->GetTeamNum() != EStrategyTeam::Unknown)
+		{
+			if (Schedule.bBatched)
+			{
+				AIDirector->SpawnMode = EStrategySpawnMode::Batched;
+			}
+			AIDirector->WaveSize += NumMinions;
+		}
+	}
+}
+
+bool UStrategySimBenchmarkCommandlet::TickMatch(FSimMatch& Match, const FWaveSchedule& Schedule, float TimeStep)
+{
+	UWorld* const World = Match.World;
+	const AStrategyGameState* const GameState = World->GetGameState<AStrategyGameState>();
+	if (GameState == nullptr || GameState->GameplayState == EGameplayState::Finished)
+	{
+		return false;
+	}
+
+	if (GameState->IsGameActive() && Match.SimTime >= Match.NextWaveTime)
+	{
+		SpawnWave(World, Schedule, Match.NumWaves);
+		Match.NextWaveTime = Match.SimTime + Schedule.Interval;
+		Match.NumWaves++;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	World->Tick(LEVELTICK_All, TimeStep);
+	Match.WallTime += FPlatformTime::Seconds() - StartTime;
+
+	Match.SimTime += TimeStep;
+	Match.NumFrames++;
+	return true;
+}
+
+TSharedRef<FJsonObject> UStrategySimBenchmarkCommandlet::BuildMatchReport(const FSimMatch& Match) const
+{
+	const AStrategyGameState* const GameState = Match.World->GetGameState<AStrategyGameState>();
+	const bool bFinished = GameState != nullptr && GameState->GameplayState == EGameplayState::Finished;
+	const UStrategySimProfiler* const Profiler = Match.World->GetSubsystem<UStrategySimProfiler>();
+
+	TSharedRef<FJsonObject> Report = MakeShareable(new FJsonObject());
+	Report->SetNumberField(TEXT("Seed"), Match.Seed);
+	Report->SetNumberField(TEXT("Frames"), Match.NumFrames);
+	Report->SetNumberField(TEXT("Waves"), Match.NumWaves);
+	Report->SetNumberField(TEXT("SimSeconds"), Match.SimTime);
+	Report->SetNumberField(TEXT("WallSeconds"), Match.WallTime);
+	Report->SetBoolField(TEXT("GameFinished"), bFinished);
+	Report->SetNumberField(TEXT("WinningTeam"), bFinished ? (int32)GameState->GetWinningTeam() : (int32)EStrategyTeam::Unknown);
+
+	// path requests are what flow fields save, field builds are what they cost
+	const UStrategyFlowFieldSubsystem* const FlowFields = Match.World->GetSubsystem<UStrategyFlowFieldSubsystem>();
+	if (FlowFields != nullptr)
+	{
+		Report->SetNumberField(TEXT("PathRequests"), FlowFields->GetNumPathRequests());
+		Report->SetNumberField(TEXT("PathRequestsPerWave"), Match.NumWaves > 0 ? double(FlowFields->GetNumPathRequests()) / Match.NumWaves : 0.0);
+		Report->SetNumberField(TEXT("FlowFieldBuilds"), FlowFields->GetNumFieldBuilds());
+		Report->SetNumberField(TEXT("FlowFieldBuildMs"), FlowFields->GetBuildSeconds() * 1000.0);
+		Report->SetNumberField(TEXT("FlowFieldMaxFrameMs"), FlowFields->GetMaxBuildSliceSeconds() * 1000.0);
+	}
+
+	TSharedRef<FJsonObject> Systems = MakeShareable(new FJsonObject());
+	for (int32 Idx = 0; Idx < EStrategySimStat::MAX; Idx++)
+	{
+		const EStrategySimStat::Type Stat = (EStrategySimStat::Type)Idx;
+		const double Seconds = Profiler != nullptr ? Profiler->GetSeconds(Stat) : 0.0;
+
+		TSharedRef<FJsonObject> System = MakeShareable(new FJsonObject());
+		System->SetNumberField(TEXT("TotalMs"), Seconds * 1000.0);
+		System->SetNumberField(TEXT("AvgFrameMs"), Match.NumFrames > 0 ? Seconds * 1000.0 / Match.NumFrames : 0.0);
+		Systems->SetObjectField(UStrategySimProfiler::GetStatName(Stat), System);
+	}
+	Report->SetObjectField(TEXT("Systems"), Systems);
+
+	return Report;
+}
+
+int32 UStrategySimBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString MapName = TEXT("/Game/Maps/TowerDefenseMap");
+	FString OutputFile = FPaths::ProfilingDir() / TEXT("StrategySimBenchmark.json");
+	float SimMinutes = 5.0f;
+	float TimeStep = 1.0f / 30.0f;
+	int32 Seed = 1;
+	int32 NumWorlds = 1;
+
+	FWaveSchedule Schedule;
+	Schedule.Interval = 20.0f;
+	Schedule.Size = 5;
+	Schedule.Growth = 1;
+	Schedule.bBatched = FParse::Param(*Params, TEXT("Batched"));
+
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("Output="), OutputFile);
+	FParse::Value(*Params, TEXT("Minutes="), SimMinutes);
+	FParse::Value(*Params, TEXT("Step="), TimeStep);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Worlds="), NumWorlds);
+	FParse::Value(*Params, TEXT("WaveInterval="), Schedule.Interval);
+	FParse::Value(*Params, TEXT("WaveSize="), Schedule.Size);
+	FParse::Value(*Params, TEXT("WaveGrowth="), Schedule.Growth);
+
+	// flow field on and off gives path requests per wave before and after, budget 0 gives single frame builds
+	float FlowFieldBudget = -1.0f;
+	FParse::Value(*Params, TEXT("FlowFieldBudget="), FlowFieldBudget);
+	if (FlowFieldBudget >= 0.0f)
+	{
+		IConsoleManager::Get().FindConsoleVariable(TEXT("Strategy.AI.FlowFieldBuildBudget"))->Set(FlowFieldBudget);
+	}
+	if (FParse::Param(*Params, TEXT("NoFlowField")))
+	{
+		IConsoleManager::Get().FindConsoleVariable(TEXT("Strategy.AI.FlowField"))->Set(0);
+	}
+	if (FParse::Param(*Params, TEXT("NoProjectileActors")))
+	{
+		IConsoleManager::Get().FindConsoleVariable(TEXT("Strategy.Projectiles.MoveActors"))->Set(0);
+	}
+
+	if (!MapName.StartsWith(TEXT("/")))
+	{
+		MapName = FString(TEXT("/Game/Maps/")) / MapName;
+	}
+	TimeStep = FMath::Max(TimeStep, KINDA_SMALL_NUMBER);
+	Schedule.Interval = FMath::Max(Schedule.Interval, TimeStep);
+	NumWorlds = FMath::Max(NumWorlds, 1);
+
+	// every match gets its own world, game state, subsystems and seed
+	TArray<FSimMatch> Matches;
+	for (int32 Idx = 0; Idx < NumWorlds; Idx++)
+	{
+		FSimMatch Match;
+		FMemory::Memzero(Match);
+		Match.Seed = Seed + Idx;
+		Match.World = LoadWorld(MapName, Match.Seed, Idx);
+		if (Match.World == nullptr)
+		{
+			for (const FSimMatch& LoadedMatch : Matches)
+			{
+				UnloadWorld(LoadedMatch.World);
+			}
+			return 1;
+		}
+
+		UStrategySimProfiler* const Profiler = Match.World->GetSubsystem<UStrategySimProfiler>();
+		if (Profiler != nullptr)
+		{
+			Profiler->Reset();
+			Profiler->SetEnabled(true);
+		}
+
+		Matches.Add(Match);
+	}
+
+	for (int32 Idx = 0; Idx < Matches.Num(); Idx++)
+	{
+		for (int32 OtherIdx = Idx + 1; OtherIdx < Matches.Num(); OtherIdx++)
+		{
+			checkf(Matches[Idx].World != Matches[OtherIdx].World, TEXT("Matches %d and %d share world %s"), Idx, OtherIdx, *Matches[Idx].World->GetPathName());
+		}
+	}
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(TimeStep);
+
+	const int32 NumFrames = FMath::CeilToInt(SimMinutes * 60.0f / TimeStep);
+	const int32 MemorySampleFrames = FMath::Max(1, FMath::RoundToInt(1.0f / TimeStep));
+	uint64 PeakUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	int32 NumMatchesRunning = Matches.Num();
+	double GCTime = 0.0;
+
+#if CSV_PROFILER
+	// character movement has no scope of ours, engine's CharacterMovement CSV stat is captured next to the report
+	const bool bCsvCapture = FParse::Param(*Params, TEXT("Csv"));
+	if (bCsvCapture)
+	{
+		FCsvProfiler::Get()->BeginCapture(-1, FPaths::GetPath(OutputFile), FPaths::GetBaseFilename(OutputFile) + TEXT(".csv"));
+	}
+#endif
+
+	UE_LOG(LogStrategySimBenchmark, Display, TEXT("Simulating %d match(es) of %s for %.1f minutes, step %.4f s, seed %d"), Matches.Num(), *MapName, SimMinutes, TimeStep, Seed);
+
+	// world ticking, physics scenes and garbage collection are bound to game thread, so worlds advance round robin:
+	// one frame of each world per step
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 FrameIdx = 0; FrameIdx < NumFrames && NumMatchesRunning > 0 && !IsEngineExitRequested(); FrameIdx++)
+	{
+		FApp::SetDeltaTime(TimeStep);
+		FApp::SetCurrentTime(FApp::GetCurrentTime() + TimeStep);
+#if CSV_PROFILER
+		if (bCsvCapture)
+		{
+			FCsvProfiler::Get()->BeginFrame();
+		}
+#endif
+
+		for (FSimMatch& Match : Matches)
+		{
+			if (!Match.bDone && !TickMatch(Match, Schedule, TimeStep))
+			{
+				Match.bDone = true;
+				NumMatchesRunning--;
+			}
+		}
+
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick(TimeStep);
+
+		// same garbage collection cadence as engine loop, dead minions and projectiles don't pile up in memory stats
+		const double GCStartTime = FPlatformTime::Seconds();
+		GEngine->ConditionalCollectGarbage();
+		GCTime += FPlatformTime::Seconds() - GCStartTime;
+
+#if CSV_PROFILER
+		if (bCsvCapture)
+		{
+			FCsvProfiler::Get()->EndFrame();
+		}
+#endif
+		GFrameCounter++;
+
+		// memory stats are not free, sample them once per simulated second
+		if (FrameIdx % MemorySampleFrames == 0)
+		{
+			PeakUsedPhysical = FMath::Max(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+		}
+	}
+	const double WallTime = FPlatformTime::Seconds() - StartTime;
+
+	FString CsvFile;
+#if CSV_PROFILER
+	if (bCsvCapture)
+	{
+		CsvFile = FCsvProfiler::Get()->EndCapture().Get();
+	}
+#endif
+
+	// report, totals over all matches followed by each match
+	double TotalSimTime = 0.0;
+	int32 TotalFrames = 0;
+	int32 NumFinished = 0;
+	TArray<int32> NumWins;
+	NumWins.AddZeroed(EStrategyTeam::MAX);
+	double SystemSeconds[EStrategySimStat::MAX] = {};
+	TArray<TSharedPtr<FJsonValue>> MatchReports;
+
+	for (const FSimMatch& Match : Matches)
+	{
+		TotalSimTime += Match.SimTime;
+		TotalFrames += Match.NumFrames;
+
+		const AStrategyGameState* const GameState = Match.World->GetGameState<AStrategyGameState>();
+		if (GameState != nullptr && GameState->GameplayState == EGameplayState::Finished)
+		{
+			NumFinished++;
+			if (!NumWins.IsValidIndex(GameState->GetWinningTeam()))
+			{
+				NumWins.AddZeroed(GameState->GetWinningTeam() + 1 - NumWins.Num());
+			}
+			NumWins[GameState->GetWinningTeam()]++;
+		}
+
+		const UStrategySimProfiler* const Profiler = Match.World->GetSubsystem<UStrategySimProfiler>();
+		for (int32 Idx = 0; Profiler != nullptr && Idx < EStrategySimStat::MAX; Idx++)
+		{
+			SystemSeconds[Idx] += Profiler->GetSeconds((EStrategySimStat::Type)Idx);
+		}
+
+		MatchReports.Add(MakeShareable(new FJsonValueObject(BuildMatchReport(Match))));
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShareable(new FJsonObject());
+	Report->SetStringField(TEXT("Map"), MapName);
+	Report->SetNumberField(TEXT("Seed"), Seed);
+	Report->SetNumberField(TEXT("Worlds"), Matches.Num());
+	Report->SetNumberField(TEXT("TimeStep"), TimeStep);
+	Report->SetNumberField(TEXT("Frames"), TotalFrames);
+	Report->SetNumberField(TEXT("SimSeconds"), TotalSimTime);
+	Report->SetNumberField(TEXT("WallSeconds"), WallTime);
+	Report->SetNumberField(TEXT("GCSeconds"), GCTime);
+	Report->SetNumberField(TEXT("SimSecondsPerWallSecond"), WallTime > 0.0 ? TotalSimTime / WallTime : 0.0);
+	Report->SetNumberField(TEXT("GamesFinished"), NumFinished);
+	Report->SetNumberField(TEXT("PlayerWins"), NumWins[EStrategyTeam::Player]);
+	Report->SetNumberField(TEXT("EnemyWins"), NumWins[EStrategyTeam::Enemy]);
+
+	TArray<TSharedPtr<FJsonValue>> WinsPerTeam;
+	for (int32 TeamNum = 0; TeamNum < NumWins.Num(); TeamNum++)
+	{
+		WinsPerTeam.Add(MakeShareable(new FJsonValueNumber(NumWins[TeamNum])));
+	}
+	Report->SetArrayField(TEXT("WinsPerTeam"), WinsPerTeam);
+	Report->SetNumberField(TEXT("PeakUsedPhysicalMB"), double(PeakUsedPhysical) / (1024.0 * 1024.0));
+	Report->SetNumberField(TEXT("PeakUsedPhysicalProcessMB"), double(FPlatformMemory::GetStats().PeakUsedPhysical) / (1024.0 * 1024.0));
+
+	TSharedRef<FJsonObject> Systems = MakeShareable(new FJsonObject());
+	for (int32 Idx = 0; Idx < EStrategySimStat::MAX; Idx++)
+	{
+		TSharedRef<FJsonObject> System = MakeShareable(new FJsonObject());
+		System->SetNumberField(TEXT("TotalMs"), SystemSeconds[Idx] * 1000.0);
+		System->SetNumberField(TEXT("AvgFrameMs"), TotalFrames > 0 ? SystemSeconds[Idx] * 1000.0 / TotalFrames : 0.0);
+		Systems->SetObjectField(UStrategySimProfiler::GetStatName((EStrategySimStat::Type)Idx), System);
+	}
+	Report->SetObjectField(TEXT("Systems"), Systems);
+	if (!CsvFile.IsEmpty())
+	{
+		Report->SetStringField(TEXT("CsvFile"), CsvFile);
+	}
+	Report->SetArrayField(TEXT("Matches"), MatchReports);
+
+	FString ReportString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	UE_LOG(LogStrategySimBenchmark, Display, TEXT("%s"), *ReportString);
+	if (!FFileHelper::SaveStringToFile(ReportString, *OutputFile))
+	{
+		UE_LOG(LogStrategySimBenchmark, Error, TEXT("Failed to write %s"), *OutputFile);
+	}
+
+	for (const FSimMatch& Match : Matches)
+	{
+		UStrategySimProfiler* const Profiler = Match.World->GetSubsystem<UStrategySimProfiler>();
+		if (Profiler != nullptr)
+		{
+			Profiler->SetEnabled(false);
+		}
+		UnloadWorld(Match.World);
+	}
+
+	return 0;
+}
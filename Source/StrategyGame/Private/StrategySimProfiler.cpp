@@ -0,0 +1,60 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategySimProfiler.h"
+
+int32 UStrategySimProfiler::NumEnabled = 0;
+
+UStrategySimProfiler::UStrategySimProfiler()
+	: bEnabled(false)
+{
+	Reset();
+}
+
+void UStrategySimProfiler::Deinitialize()
+{
+	SetEnabled(false);
+
+	Super::Deinitialize();
+}
+
+void UStrategySimProfiler::SetEnabled(bool bEnable)
+{
+	if (bEnabled != bEnable)
+	{
+		NumEnabled += bEnable ? 1 : -1;
+		bEnabled = bEnable;
+	}
+}
+
+double UStrategySimProfiler::GetSeconds(EStrategySimStat::Type Stat) const
+{
+	return FPlatformTime::ToSeconds64(Cycles[Stat]);
+}
+
+void UStrategySimProfiler::Reset()
+{
+	FMemory::Memzero(Cycles);
+}
+
+const TCHAR* UStrategySimProfiler::GetStatName(EStrategySimStat::Type Stat)
+{
+	switch (Stat)
+	{
+	case EStrategySimStat::AI:			return TEXT("AI");
+	case EStrategySimStat::Sensing:		return TEXT("Sensing");
+	case EStrategySimStat::Projectiles:	return TEXT("Projectiles");
+	case EStrategySimStat::Buildings:	return TEXT("Buildings");
+	default:							return TEXT("Unknown");
+	}
+}
+
+void FStrategySimProfileScope::Begin(const UWorld* World)
+{
+	UStrategySimProfiler* const WorldProfiler = World ? World->GetSubsystem<UStrategySimProfiler>() : nullptr;
+	if (WorldProfiler && WorldProfiler->IsEnabled())
+	{
+		Profiler = WorldProfiler;
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
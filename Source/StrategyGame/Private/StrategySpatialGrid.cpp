@@ -0,0 +1,204 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategySpatialGrid.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spatial grid update"), STAT_StrategyGridUpdate, STATGROUP_StrategyAI);
+DECLARE_CYCLE_STAT(TEXT("Spatial grid query"), STAT_StrategyGridQuery, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spatial grid queries"), STAT_StrategyGridNumQueries, STATGROUP_StrategyAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spatial grid candidates tested"), STAT_StrategyGridNumCandidates, STATGROUP_StrategyAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spatial grid characters"), STAT_StrategyGridNumChars, STATGROUP_StrategyAI);
+
+UStrategySpatialGrid::UStrategySpatialGrid()
+	: CellSize(500.0f), NumChars(0)
+{
+}
+
+void UStrategySpatialGrid::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// guard against bad config values
+	CellSize = FMath::Max(CellSize, 100.0f);
+}
+
+void UStrategySpatialGrid::Deinitialize()
+{
+	Entries.Reset();
+	FreeEntries.Reset();
+	Cells.Reset();
+	NumChars = 0;
+
+	Super::Deinitialize();
+}
+
+bool UStrategySpatialGrid::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategySpatialGrid::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategySpatialGrid, STATGROUP_Tickables);
+}
+
+FIntPoint UStrategySpatialGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UStrategySpatialGrid::AddToCell(int32 EntryIndex, const FIntPoint& Cell)
+{
+	FGridEntry& Entry = Entries[EntryIndex];
+	TArray<int32>& CellEntries = Cells.FindOrAdd(Cell);
+
+	Entry.Cell        = Cell;
+	Entry.IndexInCell = CellEntries.Add(EntryIndex);
+}
+
+void UStrategySpatialGrid::RemoveFromCell(int32 EntryIndex)
+{
+	const FGridEntry& Entry = Entries[EntryIndex];
+	TArray<int32>* const CellEntries = Cells.Find(Entry.Cell);
+	if (CellEntries == nullptr)
+	{
+		return;
+	}
+
+	// swap with last one in cell and fix its index
+	CellEntries->RemoveAtSwap(Entry.IndexInCell, 1, false);
+	if (CellEntries->IsValidIndex(Entry.IndexInCell))
+	{
+		Entries[(*CellEntries)[Entry.IndexInCell]].IndexInCell = Entry.IndexInCell;
+	}
+
+	if (CellEntries->Num() == 0)
+	{
+		Cells.Remove(Entry.Cell);
+	}
+}
+
+void UStrategySpatialGrid::RegisterChar(AStrategyChar* InChar)
+{
+	if (InChar == nullptr || InChar->SpatialGridIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	int32 EntryIndex = INDEX_NONE;
+	if (FreeEntries.Num() > 0)
+	{
+		EntryIndex = FreeEntries.Pop(false);
+	}
+	else
+	{
+		EntryIndex = Entries.AddUninitialized();
+		Entries[EntryIndex].Serial = 0;
+	}
+
+	Entries[EntryIndex].Char = InChar;
+	AddToCell(EntryIndex, GetCell(InChar->GetActorLocation()));
+
+	InChar->SpatialGridIndex = EntryIndex;
+	NumChars++;
+}
+
+void UStrategySpatialGrid::UnregisterChar(AStrategyChar* InChar)
+{
+	if (InChar == nullptr || !Entries.IsValidIndex(InChar->SpatialGridIndex) || Entries[InChar->SpatialGridIndex].Char != InChar)
+	{
+		return;
+	}
+
+	const int32 EntryIndex = InChar->SpatialGridIndex;
+	RemoveFromCell(EntryIndex);
+	Entries[EntryIndex].Char = nullptr;
+	Entries[EntryIndex].Serial++;
+	FreeEntries.Add(EntryIndex);
+
+	InChar->SpatialGridIndex = INDEX_NONE;
+	NumChars--;
+}
+
+int32 UStrategySpatialGrid::GetNumChars() const
+{
+	return NumChars;
+}
+
+FStrategyGridHandle UStrategySpatialGrid::GetHandle(const AStrategyChar* InChar) const
+{
+	FStrategyGridHandle Handle;
+	if (InChar != nullptr && Entries.IsValidIndex(InChar->SpatialGridIndex) && Entries[InChar->SpatialGridIndex].Char == InChar)
+	{
+		Handle.Slot   = InChar->SpatialGridIndex;
+		Handle.Serial = Entries[InChar->SpatialGridIndex].Serial;
+	}
+
+	return Handle;
+}
+
+void UStrategySpatialGrid::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyGridUpdate);
+
+	// move characters which crossed cell border
+	for (int32 Idx = 0; Idx < Entries.Num(); Idx++)
+	{
+		const FGridEntry& Entry = Entries[Idx];
+		if (Entry.Char != nullptr)
+		{
+			const FIntPoint NewCell = GetCell(Entry.Char->GetActorLocation());
+			if (NewCell != Entry.Cell)
+			{
+				RemoveFromCell(Idx);
+				AddToCell(Idx, NewCell);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_StrategyGridNumChars, NumChars);
+}
+
+void UStrategySpatialGrid::ForEachCharInRadius(const FVector& Origin, float Radius, TFunctionRef<void(AStrategyChar*)> Func) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_StrategyGridQuery);
+
+	const float RadiusSq = FMath::Square(Radius);
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius, Radius, 0.0f));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius, Radius, 0.0f));
+
+	int32 NumCandidates = 0;
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+		{
+			const TArray<int32>* const CellEntries = Cells.Find(FIntPoint(CellX, CellY));
+			if (CellEntries == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 Idx = 0; Idx < CellEntries->Num(); Idx++)
+			{
+				AStrategyChar* const TestChar = Entries[(*CellEntries)[Idx]].Char;
+				NumCandidates++;
+
+				if (FVector::DistSquared2D(TestChar->GetActorLocation(), Origin) <= RadiusSq)
+				{
+					Func(TestChar);
+				}
+			}
+		}
+	}
+
+	INC_DWORD_STAT(STAT_StrategyGridNumQueries);
+	INC_DWORD_STAT_BY(STAT_StrategyGridNumCandidates, NumCandidates);
+}
+
+void UStrategySpatialGrid::QueryRadius(const FVector& Origin, float Radius, TArray<AStrategyChar*>& OutChars) const
+{
+	ForEachCharInRadius(Origin, Radius, [&OutChars](AStrategyChar* FoundChar)
+	{
+		OutChars.Add(FoundChar);
+	});
+}
@@ -0,0 +1,112 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyTeamRegistry.h"
+#include "StrategyTeamInterface.h"
+
+static TAutoConsoleVariable<int32> CVarTeamRegistryEnabled(TEXT("Strategy.Teams.Registry"), 1, TEXT("If set, team relation queries use registered actor teams and relation table instead of team interface casts."));
+
+UStrategyTeamRegistry::UStrategyTeamRegistry()
+	: NumTeams(0)
+{
+}
+
+void UStrategyTeamRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	SetNumTeams(EStrategyTeam::MAX);
+}
+
+void UStrategyTeamRegistry::Deinitialize()
+{
+	ActorTeams.Empty();
+	Relations.Empty();
+	NumTeams = 0;
+
+	Super::Deinitialize();
+}
+
+bool UStrategyTeamRegistry::IsEnabled()
+{
+	return CVarTeamRegistryEnabled.GetValueOnGameThread() != 0;
+}
+
+void UStrategyTeamRegistry::SetTeam(const AActor* Actor, uint8 TeamNum)
+{
+	if (Actor == nullptr || !ensure(TeamNum < NotRegistered))
+	{
+		return;
+	}
+
+	SetNumTeams(TeamNum + 1);
+	ActorTeams.Add(Actor, TeamNum);
+}
+
+void UStrategyTeamRegistry::RemoveActor(const AActor* Actor)
+{
+	if (Actor != nullptr)
+	{
+		ActorTeams.Remove(Actor);
+	}
+}
+
+void UStrategyTeamRegistry::SetRelation(uint8 TeamA, uint8 TeamB, EStrategyTeamRelation::Type Relation)
+{
+	if (!ensure(TeamA < NotRegistered && TeamB < NotRegistered))
+	{
+		return;
+	}
+
+	SetNumTeams(FMath::Max(TeamA, TeamB) + 1);
+	Relations[TeamA * NumTeams + TeamB] = Relation;
+	Relations[TeamB * NumTeams + TeamA] = Relation;
+}
+
+void UStrategyTeamRegistry::SetNumTeams(int32 NewNumTeams)
+{
+	if (NewNumTeams <= NumTeams)
+	{
+		return;
+	}
+
+	// keep overridden relations of existing teams
+	TArray<uint8> NewRelations;
+	NewRelations.AddUninitialized(NewNumTeams * NewNumTeams);
+	for (int32 TeamA = 0; TeamA < NewNumTeams; TeamA++)
+	{
+		for (int32 TeamB = 0; TeamB < NewNumTeams; TeamB++)
+		{
+			NewRelations[TeamA * NewNumTeams + TeamB] = (TeamA < NumTeams && TeamB < NumTeams) ? Relations[TeamA * NumTeams + TeamB] : GetDefaultRelation(TeamA, TeamB);
+		}
+	}
+
+	Relations = MoveTemp(NewRelations);
+	NumTeams = NewNumTeams;
+}
+
+uint8 UStrategyTeamRegistry::GetUnregisteredTeam(const AActor* Actor)
+{
+	const IStrategyTeamInterface* const TeamInterface = Cast<const IStrategyTeamInterface>(Actor);
+	return TeamInterface != nullptr ? TeamInterface->GetTeamNum() : NoTeam;
+}
+
+EStrategyTeamRelation::Type UStrategyTeamRegistry::GetDefaultRelation(uint8 TeamA, uint8 TeamB)
+{
+	// unknown team is friendly to everything, even to actors without team
+	if (TeamA == EStrategyTeam::Unknown || TeamB == EStrategyTeam::Unknown)
+	{
+		return EStrategyTeamRelation::Friendly;
+	}
+
+	if (TeamA == NoTeam || TeamB == NoTeam)
+	{
+		return EStrategyTeamRelation::None;
+	}
+
+	return (TeamA == TeamB) ? EStrategyTeamRelation::Friendly : EStrategyTeamRelation::Enemy;
+}
+
+EStrategyTeamRelation::Type UStrategyTeamRegistry::GetRelationByInterface(const AActor* ActorA, const AActor* ActorB)
+{
+	return GetDefaultRelation(GetUnregisteredTeam(ActorA), GetUnregisteredTeam(ActorB));
+}
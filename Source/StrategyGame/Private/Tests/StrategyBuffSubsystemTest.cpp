@@ -0,0 +1,61 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyBuffSubsystem.h"
+#include "StrategyTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStrategyBuffsTest, "StrategyGame.Perf.Buffs", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FStrategyBuffsTest::RunTest(const FString& Parameters)
+{
+	const int32 NumMinions = 1000;
+	const int32 NumBuffs = 10000;
+
+	StrategyTest::FTestWorld TestWorld;
+	UStrategyBuffSubsystem* const Buffs = TestWorld.World->GetSubsystem<UStrategyBuffSubsystem>();
+	if (!TestNotNull(TEXT("Buff subsystem"), Buffs))
+	{
+		return false;
+	}
+
+	TArray<AStrategyChar*> Minions;
+	TestWorld.SpawnMinions(NumMinions, EStrategyTeam::Enemy, Minions);
+
+	FRandomStream RandomStream(NumBuffs);
+	FBuffData Buff;
+	Buff.BuffData.AttackMin = 0;
+	Buff.BuffData.AttackMax = 1;
+	Buff.BuffData.AttackDistance = 0;
+	Buff.BuffData.HealthRegen = 0;
+	Buff.BuffData.Speed = 10.0f;
+
+	// every minion recomputes its stats after each new buff, as ApplyBuff does
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumBuffs; Idx++)
+	{
+		AStrategyChar* const Minion = Minions[Idx % Minions.Num()];
+		Buff.Duration = RandomStream.FRandRange(1.0f, 10.0f);
+		Buffs->AddBuff(Minion, Buff);
+
+		FPawnData PawnData = *Minion->GetPawnData();
+		Buffs->AccumulateBuffs(Minion, PawnData);
+	}
+	const double ApplyTime = FPlatformTime::Seconds() - StartTime;
+	TestEqual(TEXT("Active buffs after applying"), Buffs->GetNumBuffs(), NumBuffs);
+
+	// all buffs are done by then
+	StartTime = FPlatformTime::Seconds();
+	const int32 NumUpdatedMinions = Buffs->ExpireBuffs(TestWorld.World->GetTimeSeconds() + 10.0f);
+	const double ExpireTime = FPlatformTime::Seconds() - StartTime;
+	TestEqual(TEXT("Minions updated by expiry"), NumUpdatedMinions, NumMinions);
+	TestEqual(TEXT("Active buffs after expiry"), Buffs->GetNumBuffs(), 0);
+
+	AddInfo(FString::Printf(TEXT("Buffs, %d buffs on %d minions: apply %.3f ms, expire %.3f ms"),
+		NumBuffs, NumMinions, ApplyTime * 1000.0, ExpireTime * 1000.0));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
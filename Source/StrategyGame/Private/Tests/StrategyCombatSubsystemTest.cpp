@@ -0,0 +1,116 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyCombatSubsystem.h"
+#include "StrategyTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StrategyCombatTest
+{
+	/** health of every victim before each path, enough to survive all hits */
+	const float VictimHealth = 10000000.0f;
+
+	/** restore health of victims */
+	void ResetHealth(const TArray<AStrategyChar*>& Victims)
+	{
+		for (AStrategyChar* Victim : Victims)
+		{
+			Victim->Health = VictimHealth;
+		}
+	}
+
+	/** get total damage taken by victims since last reset */
+	double GetDamageTaken(const TArray<AStrategyChar*>& Victims)
+	{
+		double DamageTaken = 0.0;
+		for (const AStrategyChar* Victim : Victims)
+		{
+			DamageTaken += VictimHealth - Victim->Health;
+		}
+
+		return DamageTaken;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStrategyDamageTest, "StrategyGame.Perf.Damage", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FStrategyDamageTest::RunTest(const FString& Parameters)
+{
+	using namespace StrategyCombatTest;
+
+	const int32 NumHits = 100000;
+	const int32 NumVictims = 100;
+	const float HitDamage = 1000.0f;
+
+	StrategyTest::FTestWorld TestWorld;
+	UStrategyCombatSubsystem* const Combat = TestWorld.World->GetSubsystem<UStrategyCombatSubsystem>();
+	if (!TestNotNull(TEXT("Combat subsystem"), Combat) || !TestNotNull(TEXT("Game mode"), TestWorld.World->GetAuthGameMode<AStrategyGameMode>()))
+	{
+		return false;
+	}
+
+	// one minion attacks all the others
+	TArray<AStrategyChar*> Attackers;
+	TArray<AStrategyChar*> Victims;
+	TestWorld.SpawnMinions(1, EStrategyTeam::Player, Attackers);
+	TestWorld.SpawnMinions(NumVictims, EStrategyTeam::Enemy, Victims);
+	AStrategyChar* const Attacker = Attackers[0];
+
+	const FDamageEvent DamageEvent(UDamageType::StaticClass());
+
+	// baseline: every hit through TakeDamage and game mode rules, as before combat subsystem
+	IConsoleVariable* const BatchDamageVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Strategy.Combat.BatchDamage"));
+	if (!TestNotNull(TEXT("Strategy.Combat.BatchDamage"), BatchDamageVar))
+	{
+		return false;
+	}
+	const int32 SavedBatchDamage = BatchDamageVar->GetInt();
+	BatchDamageVar->Set(0, ECVF_SetByCode);
+
+	ResetHealth(Victims);
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumHits; Idx++)
+	{
+		UGameplayStatics::ApplyDamage(Victims[Idx % NumVictims], HitDamage, nullptr, Attacker, UDamageType::StaticClass());
+	}
+	const double UnbatchedTime = FPlatformTime::Seconds() - StartTime;
+	const double UnbatchedDamage = GetDamageTaken(Victims);
+
+	BatchDamageVar->Set(1, ECVF_SetByCode);
+
+	// single entries resolved right away by combat subsystem, as for projectiles
+	ResetHealth(Victims);
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumHits; Idx++)
+	{
+		UGameplayStatics::ApplyDamage(Victims[Idx % NumVictims], HitDamage, nullptr, Attacker, UDamageType::StaticClass());
+	}
+	const double SingleTime = FPlatformTime::Seconds() - StartTime;
+	const double SingleDamage = GetDamageTaken(Victims);
+
+	ResetHealth(Victims);
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumHits; Idx++)
+	{
+		Combat->QueueDamage(Victims[Idx % NumVictims], HitDamage, DamageEvent, nullptr, Attacker);
+	}
+	Combat->FlushDamage();
+	const double BatchTime = FPlatformTime::Seconds() - StartTime;
+	const double BatchDamage = GetDamageTaken(Victims);
+
+	BatchDamageVar->Set(SavedBatchDamage, ECVF_SetByCode);
+
+	// all paths follow the same game rules
+	TestTrue(TEXT("Unbatched damage dealt"), UnbatchedDamage > 0.0);
+	TestEqual(TEXT("Single damage matches unbatched"), SingleDamage, UnbatchedDamage, UnbatchedDamage * 0.001);
+	TestEqual(TEXT("Batch damage matches unbatched"), BatchDamage, UnbatchedDamage, UnbatchedDamage * 0.001);
+
+	AddInfo(FString::Printf(TEXT("Damage, %d hits on %d minions: unbatched %.3f ms (%.3f us/hit), single %.3f ms (%.3f us/hit), batch %.3f ms (%.3f us/hit)"),
+		NumHits, NumVictims, UnbatchedTime * 1000.0, UnbatchedTime * 1000000.0 / NumHits, SingleTime * 1000.0, SingleTime * 1000000.0 / NumHits,
+		BatchTime * 1000.0, BatchTime * 1000000.0 / NumHits));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,223 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyTargetingSubsystem.h"
+#include "StrategyAIController.h"
+#include "StrategyAISensingComponent.h"
+#include "StrategySpatialGrid.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StrategyTargetingTest
+{
+	/** target selection as done by AStrategyAIController before targeting subsystem, with claims kept by each target */
+	struct FLegacySelection
+	{
+		TArray<int32> CurrentTargets;
+		TArray<TArray<int32>> ClaimedBy;
+
+		void Init(int32 NumUnits)
+		{
+			CurrentTargets.Init(INDEX_NONE, NumUnits);
+			ClaimedBy.SetNum(NumUnits);
+		}
+
+		int32 SelectTarget(const TArray<AStrategyChar*>& Chars, const TArray<AStrategyAIController*>& Controllers, int32 Attacker, bool bBlind)
+		{
+			const FVector PawnLocation = Chars[Attacker]->GetActorLocation();
+			float BestUnitScore = 10000;
+			int32 BestUnit = INDEX_NONE;
+			for (int32 Idx = 0; Idx < Chars.Num() && !bBlind; Idx++)
+			{
+				if (Idx == Attacker || Chars[Idx]->GetTeamNum() == Chars[Attacker]->GetTeamNum())
+				{
+					continue;
+				}
+
+				float TargetScore = (PawnLocation - Chars[Idx]->GetActorLocation()).SizeSquared();
+				if (CurrentTargets[Attacker] == Idx)
+				{
+					TargetScore -= FMath::Square(300.0f);
+				}
+
+				if (Controllers[Idx] != nullptr)
+				{
+					if (ClaimedBy[Idx].Contains(Attacker))
+					{
+						TargetScore -= FMath::Square(300.0f);
+					}
+					else
+					{
+						TargetScore += ClaimedBy[Idx].Num() * FMath::Square(900.0f);
+					}
+				}
+
+				if (BestUnit == INDEX_NONE || BestUnitScore > TargetScore)
+				{
+					BestUnitScore = TargetScore;
+					BestUnit = Idx;
+				}
+			}
+
+			const int32 OldTarget = CurrentTargets[Attacker];
+			CurrentTargets[Attacker] = BestUnit;
+			if (BestUnit != INDEX_NONE && OldTarget != BestUnit)
+			{
+				if (OldTarget != INDEX_NONE && Controllers[OldTarget] != nullptr)
+				{
+					ClaimedBy[OldTarget].Remove(Attacker);
+				}
+
+				if (Controllers[BestUnit] != nullptr)
+				{
+					ClaimedBy[BestUnit].AddUnique(Attacker);
+				}
+			}
+
+			return BestUnit;
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStrategyTargetingMatchesLegacyTest, "StrategyGame.AI.TargetingMatchesLegacy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FStrategyTargetingMatchesLegacyTest::RunTest(const FString& Parameters)
+{
+	using namespace StrategyTargetingTest;
+
+	// two armies meeting in the middle of the map, a few units of each without AI controller
+	const int32 NumUnitsPerTeam = 24;
+	const int32 NumRounds = 16;
+	const int32 BlindUnit = 1;
+	FRandomStream RandomStream(1234);
+
+	UWorld* const World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	UStrategySpatialGrid* const Grid = World->GetSubsystem<UStrategySpatialGrid>();
+	UStrategyTargetingSubsystem* const Targeting = World->GetSubsystem<UStrategyTargetingSubsystem>();
+	if (!TestNotNull(TEXT("Spatial grid"), Grid) || !TestNotNull(TEXT("Targeting subsystem"), Targeting))
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<AStrategyChar*> Chars;
+	TArray<AStrategyAIController*> Controllers;
+	for (int32 Idx = 0; Idx < NumUnitsPerTeam * 2; Idx++)
+	{
+		const uint8 TeamNum = Idx < NumUnitsPerTeam ? EStrategyTeam::Player : EStrategyTeam::Enemy;
+		const FVector Location = FVector(TeamNum == EStrategyTeam::Player ? -600.0f : 600.0f, 0, 0) + FVector(RandomStream.FRandRange(-800.0f, 800.0f), RandomStream.FRandRange(-1500.0f, 1500.0f), 0);
+
+		const FTransform SpawnTransform(Location);
+		AStrategyChar* const Char = World->SpawnActorDeferred<AStrategyChar>(AStrategyChar::StaticClass(), SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		Char->AutoPossessAI = EAutoPossessAI::Disabled;
+		Char->SetTeamNum(TeamNum);
+		Char->FinishSpawning(SpawnTransform);
+		Chars.Add(Char);
+
+		AStrategyAIController* Controller = nullptr;
+		if ((Idx % 8) != 0)
+		{
+			Controller = World->SpawnActor<AStrategyAIController>(SpawnInfo);
+			Controller->Possess(Char);
+		}
+		Controllers.Add(Controller);
+	}
+
+	// every unit knows about every other unit, in the same order legacy selection walks them
+	for (int32 Idx = 0; Idx < Controllers.Num(); Idx++)
+	{
+		for (int32 OtherIdx = 0; Controllers[Idx] != nullptr && OtherIdx < Chars.Num(); OtherIdx++)
+		{
+			if (OtherIdx != Idx)
+			{
+				Controllers[Idx]->GetSensingComponent()->KnownTargets.Add(Grid, Chars[OtherIdx]);
+			}
+		}
+	}
+
+	FLegacySelection Legacy;
+	Legacy.Init(Chars.Num());
+
+	int32 NumMismatches = 0;
+	for (int32 Round = 0; Round < NumRounds; Round++)
+	{
+		// one unit loses all its targets for a round, it keeps its claim and doesn't release it when it picks a target again
+		const bool bBlindRound = Round == NumRounds / 2;
+		if (bBlindRound)
+		{
+			Controllers[BlindUnit]->GetSensingComponent()->KnownTargets.Reset();
+		}
+
+		for (int32 Attacker = 0; Attacker < Chars.Num(); Attacker++)
+		{
+			if (Controllers[Attacker] == nullptr)
+			{
+				continue;
+			}
+
+			const int32 LegacyTarget = Legacy.SelectTarget(Chars, Controllers, Attacker, bBlindRound && Attacker == BlindUnit);
+			Targeting->SelectTarget(Controllers[Attacker]);
+			const int32 SubsystemTarget = Chars.IndexOfByKey(Controllers[Attacker]->CurrentTarget);
+			if (LegacyTarget != SubsystemTarget)
+			{
+				AddError(FString::Printf(TEXT("Round %d, unit %d: legacy selection picked %d, targeting subsystem picked %d"), Round, Attacker, LegacyTarget, SubsystemTarget));
+				NumMismatches++;
+			}
+		}
+
+		if (bBlindRound)
+		{
+			for (int32 OtherIdx = 0; OtherIdx < Chars.Num(); OtherIdx++)
+			{
+				if (OtherIdx != BlindUnit)
+				{
+					Controllers[BlindUnit]->GetSensingComponent()->KnownTargets.Add(Grid, Chars[OtherIdx]);
+				}
+			}
+		}
+
+		// armies close in, so targets and claims keep changing
+		for (AStrategyChar* Char : Chars)
+		{
+			FVector Location = Char->GetActorLocation();
+			Location.X *= 0.9f;
+			Location += FVector(RandomStream.FRandRange(-150.0f, 150.0f), RandomStream.FRandRange(-150.0f, 150.0f), 0);
+			Char->SetActorLocation(Location);
+		}
+	}
+
+	for (int32 Idx = 0; Idx < Chars.Num(); Idx++)
+	{
+		if (Controllers[Idx] == nullptr)
+		{
+			continue;
+		}
+
+		TestEqual(FString::Printf(TEXT("Number of attackers of unit %d"), Idx), Targeting->GetNumberOfAttackers(Controllers[Idx]), Legacy.ClaimedBy[Idx].Num());
+		for (int32 Attacker = 0; Attacker < Chars.Num(); Attacker++)
+		{
+			if (Controllers[Attacker] != nullptr && Targeting->IsClaimedBy(Controllers[Idx], Controllers[Attacker]) != Legacy.ClaimedBy[Idx].Contains(Attacker))
+			{
+				AddError(FString::Printf(TEXT("Claim of unit %d on unit %d differs from legacy selection"), Attacker, Idx));
+				NumMismatches++;
+			}
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return NumMismatches == 0;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
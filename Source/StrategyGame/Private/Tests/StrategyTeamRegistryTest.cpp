@@ -0,0 +1,80 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "StrategyGame.h"
+#include "StrategyTeamRegistry.h"
+#include "StrategyAIController.h"
+#include "StrategyTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStrategyTeamRelationsTest, "StrategyGame.Perf.TeamRelations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FStrategyTeamRelationsTest::RunTest(const FString& Parameters)
+{
+	const int32 NumMinionsPerTeam = 100;
+	const int32 NumQueries = 100000;
+
+	StrategyTest::FTestWorld TestWorld;
+	const UStrategyTeamRegistry* const TeamRegistry = TestWorld.World->GetSubsystem<UStrategyTeamRegistry>();
+	if (!TestNotNull(TEXT("Team registry"), TeamRegistry))
+	{
+		return false;
+	}
+
+	// minions of both teams, half of them with AI controllers, which take team of their pawn
+	TArray<AStrategyChar*> Minions;
+	TestWorld.SpawnMinions(NumMinionsPerTeam, EStrategyTeam::Player, Minions);
+	TestWorld.SpawnMinions(NumMinionsPerTeam, EStrategyTeam::Enemy, Minions);
+
+	TArray<const AActor*> TestActors;
+	for (int32 Idx = 0; Idx < Minions.Num(); Idx++)
+	{
+		TestActors.Add(Minions[Idx]);
+		if ((Idx % 2) == 0)
+		{
+			AStrategyAIController* const Controller = TestWorld.World->SpawnActor<AStrategyAIController>();
+			Controller->Possess(Minions[Idx]);
+			TestActors.Add(Controller);
+		}
+	}
+
+	// same pairs for both runs
+	FRandomStream RandomStream(NumQueries);
+	TArray<int32> Pairs;
+	Pairs.AddUninitialized(NumQueries * 2);
+	for (int32 Idx = 0; Idx < Pairs.Num(); Idx++)
+	{
+		Pairs[Idx] = RandomStream.RandHelper(TestActors.Num());
+	}
+
+	TArray<uint8> InterfaceRelations;
+	InterfaceRelations.AddUninitialized(NumQueries);
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumQueries; Idx++)
+	{
+		InterfaceRelations[Idx] = UStrategyTeamRegistry::GetRelationByInterface(TestActors[Pairs[Idx * 2]], TestActors[Pairs[Idx * 2 + 1]]);
+	}
+	const double InterfaceTime = FPlatformTime::Seconds() - StartTime;
+
+	TArray<uint8> RegistryRelations;
+	RegistryRelations.AddUninitialized(NumQueries);
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumQueries; Idx++)
+	{
+		RegistryRelations[Idx] = TeamRegistry->GetRelation(TestActors[Pairs[Idx * 2]], TestActors[Pairs[Idx * 2 + 1]]);
+	}
+	const double RegistryTime = FPlatformTime::Seconds() - StartTime;
+
+	int32 NumMismatches = 0;
+	for (int32 Idx = 0; Idx < NumQueries; Idx++)
+	{
+		NumMismatches += (InterfaceRelations[Idx] != RegistryRelations[Idx]);
+	}
+
+	AddInfo(FString::Printf(TEXT("Team relations, %d queries over %d actors: interface %.3f ms, registry %.3f ms"),
+		NumQueries, TestActors.Num(), InterfaceTime * 1000.0, RegistryTime * 1000.0));
+	return TestEqual(TEXT("Relations different from team interface"), NumMismatches, 0);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,65 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StrategyTest
+{
+	/** Empty game world with StrategyGame's game mode and game state, destroyed with this object. */
+	struct FTestWorld
+	{
+		UWorld* World;
+		UGameInstance* GameInstance;
+
+		FTestWorld()
+		{
+			GameInstance = NewObject<UGameInstance>(GEngine);
+			GameInstance->AddToRoot();
+
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.OwningGameInstance = GameInstance;
+			WorldContext.SetCurrentWorld(World);
+			World->SetGameInstance(GameInstance);
+
+			const FURL URL;
+			World->SetGameMode(URL);
+			World->InitializeActorsForPlay(URL);
+			World->BeginPlay();
+		}
+
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+			GameInstance->RemoveFromRoot();
+		}
+
+		/**
+		 * Spawn minions in a row, without collision, actor tick and movement, for tests which call their code directly.
+		 *
+		 * @param NumMinions	Number of minions to spawn.
+		 * @param TeamNum		Team of minions.
+		 * @param OutMinions	Spawned minions are added to this.
+		 */
+		void SpawnMinions(int32 NumMinions, uint8 TeamNum, TArray<AStrategyChar*>& OutMinions) const
+		{
+			for (int32 Idx = 0; Idx < NumMinions; Idx++)
+			{
+				const FTransform SpawnTransform(FVector(Idx * 100.0f, TeamNum * 1000.0f, 0.0f));
+				AStrategyChar* const Minion = World->SpawnActorDeferred<AStrategyChar>(AStrategyChar::StaticClass(), SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+				Minion->AutoPossessAI = EAutoPossessAI::Disabled;
+				Minion->SetTeamNum(TeamNum);
+				Minion->FinishSpawning(SpawnTransform);
+
+				Minion->SetActorEnableCollision(false);
+				Minion->SetActorTickEnabled(false);
+				Minion->GetCharacterMovement()->SetComponentTickEnabled(false);
+				OutMinions.Add(Minion);
+			}
+		}
+	};
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
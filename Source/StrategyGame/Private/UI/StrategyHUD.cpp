@@ -59,6 +59,13 @@ void AStrategyHUD::DrawHUD()
 		return;
 	}
 
+	// nothing to draw while simulation runs ahead of real time
+	AStrategyGameState const* const FastForwardGameState = GetWorld()->GetGameState<AStrategyGameState>();
+	if (FastForwardGameState && FastForwardGameState->bFastForward)
+	{
+		return;
+	}
+
 	if ( GEngine && GEngine->GameViewport )
 	{
 		FVector2D ViewportSize;
@@ -119,19 +126,14 @@ void AStrategyHUD::DrawActorsHealth()
 	AStrategyGameState* const MyGameState = GetWorld()->GetGameState<AStrategyGameState>();
 	if (MyGameState)
 	{
-		// 0 - unknown/neutral team, two teams in total
-		for (int8 Team = 1; Team < EStrategyTeam::MAX; Team++)
+		// buildings of all teams still under construction
+		const TArray<TWeakObjectPtr<AStrategyBuilding>>& UnfinishedBuildings = MyGameState->GetUnfinishedBuildings();
+		for (int32 i = 0; i < UnfinishedBuildings.Num(); i++)
 		{
-			for (int32 i = 0; i < MyGameState->GetPlayerData(Team)->BuildingsList.Num(); i++) 
+			AStrategyBuilding* const TestBuilding = UnfinishedBuildings[i].Get();
+			if (TestBuilding != NULL && TestBuilding->GetHealth() > 0 && !TestBuilding->IsBuildFinished())
 			{
-				if (MyGameState->GetPlayerData(Team)->BuildingsList[i].IsValid())
-				{
-					AStrategyBuilding* const TestBuilding = Cast<AStrategyBuilding>(MyGameState->GetPlayerData(Team)->BuildingsList[i].Get());
-					if (TestBuilding != NULL && TestBuilding->GetHealth() > 0 && !TestBuilding->IsBuildFinished())
-					{
-						DrawHealthBar(TestBuilding, TestBuilding->GetHealth()/(float)TestBuilding->GetMaxHealth(), 30*UIScale);
-					}
-				}
+				DrawHealthBar(TestBuilding, TestBuilding->GetHealth()/(float)TestBuilding->GetMaxHealth(), 30*UIScale);
 			}
 		}
 	}
@@ -17,7 +17,7 @@ FReply SStrategyMiniMapWidget::OnMouseButtonDown(const FGeometry& MyGeometry, co
 		return FReply::Unhandled();
 	}
 
-	AStrategyPlayerController* const StrategyPlayerController = Cast<AStrategyPlayerController>(GEngine->GetFirstLocalPlayerController(OwnerHUD.Get()->GetWorld()));
+	AStrategyPlayerController* const StrategyPlayerController = Cast<AStrategyPlayerController>(OwnerHUD.Get()->GetWorld()->GetFirstPlayerController());
 	if( StrategyPlayerController == nullptr )
 	{
 		return FReply::Unhandled();
@@ -53,7 +53,7 @@ FReply SStrategyMiniMapWidget::OnMouseButtonDown(const FGeometry& MyGeometry, co
 void SStrategyMiniMapWidget::OnMouseLeave(const FPointerEvent& MouseEvent)
 {
 	bIsMouseButtonDown = false;
-	AStrategyPlayerController* const PlayerController = Cast<AStrategyPlayerController>(GEngine->GetFirstLocalPlayerController(OwnerHUD.Get()->GetWorld()));
+	AStrategyPlayerController* const PlayerController = Cast<AStrategyPlayerController>(OwnerHUD.Get()->GetWorld()->GetFirstPlayerController());
 	if (PlayerController != NULL)
 	{
 		PlayerController->MouseLeftMinimap();
@@ -67,7 +67,7 @@ FReply SStrategyMiniMapWidget::OnMouseButtonUp(const FGeometry& MyGeometry, cons
 	if (bIsMouseButtonDown == true )
 	{
 		bIsMouseButtonDown = false;
-		AStrategyPlayerController* const PlayerController = Cast<AStrategyPlayerController>(GEngine->GetFirstLocalPlayerController(OwnerHUD.Get()->GetWorld()));
+		AStrategyPlayerController* const PlayerController = Cast<AStrategyPlayerController>(OwnerHUD.Get()->GetWorld()->GetFirstPlayerController());
 		if (PlayerController != NULL)
 		{
 			PlayerController->MouseReleasedOverMinimap();
@@ -91,7 +91,7 @@ int32 SStrategyMiniMapWidget::OnPaint( const FPaintArgs& Args, const FGeometry&
 	SCompoundWidget::OnPaint( Args, AllottedGeometry, MyClippingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled );
 	if( OwnerHUD.IsValid() == true )
 	{
-		AStrategyPlayerController* const PC = Cast<AStrategyPlayerController>(GEngine->GetFirstLocalPlayerController(OwnerHUD.Get()->GetWorld()));
+		AStrategyPlayerController* const PC = Cast<AStrategyPlayerController>(OwnerHUD.Get()->GetWorld()->GetFirstPlayerController());
 		AStrategyGameState const* const MyGameState = PC && PC->GetWorld() ? PC->GetWorld()->GetGameState<AStrategyGameState>() : NULL;
 		AStrategyHUD* const HUD = PC ? Cast<AStrategyHUD>(PC->MyHUD) : NULL;
 		if (MyGameState && MyGameState->MiniMapCamera.IsValid() && HUD)
@@ -57,7 +57,7 @@ FLinearColor SStrategyTitle::GetTitleColors(bool bShadowColor) const
 
 	if (OwnerWorld != nullptr)
 	{
-		const APlayerController* MyOwner = GEngine->GetFirstLocalPlayerController(OwnerWorld.Get());
+		const APlayerController* MyOwner = OwnerWorld.Get()->GetFirstPlayerController();
 		AStrategyHUD* const MyHUD = (MyOwner) ? Cast<AStrategyHUD>(MyOwner->GetHUD()) : nullptr;
 		if (MyHUD)
 		{
@@ -4,6 +4,7 @@
 
 #include "StrategyTypes.h"
 #include "StrategyAIAction.h"
+#include "StrategyAIController.h"
 #include "StrategyAIAction_AttackTarget.generated.h"
 
 UCLASS()
@@ -39,6 +40,9 @@ protected:
 	/** notify about completing current move */
 	void OnMoveCompleted();
 
+	/** Called from owning controller when async path request finished. */
+	void OnPathUpdated(EPathUpdate::Type inType);
+
 	/** move closer to target */
 	void MoveCloser();
 
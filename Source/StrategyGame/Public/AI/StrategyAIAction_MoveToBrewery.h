@@ -7,8 +7,6 @@
 #include "StrategyAIAction_MoveToBrewery.generated.h"
 
 
-class INavigationPathGenerator;
-
 UCLASS()
 class UStrategyAIAction_MoveToBrewery : public UStrategyAIAction
 {
@@ -36,21 +34,36 @@ public:
 	// End StrategyAIAction interface
 
 protected:
-	/** Called from owning controller when given PathGenerator updated it's path. */
-	void OnPathUpdated(INavigationPathGenerator* PathGenerator, EPathUpdate::Type inType);
+	/** Called from owning controller when async path request finished. */
+	void OnPathUpdated(EPathUpdate::Type inType);
 
 	/** notify about completing current move */
 	void OnMoveCompleted();
 
+	/** request path to destination from navigation system */
+	void RequestPathMove();
+
+	/** steer along shared flow field, returns false if unit is not covered by the field */
+	bool FollowFlowField();
+
 	/** Acceptable distance to target destination */
 	float TargetAcceptanceRadius;
 
 	/** current destination we are moving to */
 	FVector	Destination;
 
+	/** actor we are moving to */
+	TWeakObjectPtr<const AActor> DestinationActor;
+
 	/** tells if we stared moving to target */
 	uint8	bIsMoving : 1;
 
+	/** tells if we follow flow field instead of path */
+	uint8	bFollowsFlowField : 1;
+
+	/** tells if path request failed, action is aborted on next tick */
+	uint8	bPathFailed : 1;
+
 	/** last time without movement */
 	float	NotMovingFromTime;
 };
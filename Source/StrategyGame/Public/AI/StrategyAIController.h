@@ -3,6 +3,8 @@
 
 #include "AIController.h"
 #include "StrategyTeamInterface.h"
+#include "StrategyPoolableInterface.h"
+#include "StrategyPathCacheSubsystem.h"
 #include "StrategyAIController.generated.h"
 
 
@@ -18,16 +20,29 @@ namespace EPathUpdate
 	};
 }
 
+namespace EStrategyAILOD
+{
+	enum Type
+	{
+		/** decisions every frame */
+		Full,
+		/** decisions at reduced rate */
+		Reduced
+	};
+}
+
 DECLARE_DELEGATE_OneParam(FOnBumpEvent, FHitResult const&);
 DECLARE_DELEGATE(FOnMovementEvent);
+DECLARE_DELEGATE_OneParam(FOnPathEvent, EPathUpdate::Type);
 
 class APawn;
 class AActor;
 class UStrategyAIAction;
 class UStrategyAISensingComponent;
+class UStrategyTeamRegistry;
 
-UCLASS()
-class AStrategyAIController : public AAIController, public IStrategyTeamInterface
+UCLASS(config=Game)
+class AStrategyAIController : public AAIController, public IStrategyTeamInterface, public IStrategyPoolableInterface
 {
 	GENERATED_UCLASS_BODY()
 
@@ -82,6 +97,11 @@ public:
 	virtual uint8 GetTeamNum() const override;
 	// End StrategyTeamInterface Interface
 
+	// Begin StrategyPoolableInterface Interface
+	virtual void OnPooled() override;
+	virtual void OnUnpooled() override;
+	// End StrategyPoolableInterface Interface
+
 	/** Checks if we are allowed to use some action */
 	bool IsActionAllowed(TSubclassOf<UStrategyAIAction> inClass) const;
 
@@ -125,27 +145,88 @@ public:
 	/** unregister bump notify */
 	void UnregisterBumpEventDelegate();
 
+	/** register path notify, to get notify when async path request finished */
+	void RegisterPathEventDelegate(FOnPathEvent);
+	/** unregister path notify */
+	void UnregisterPathEventDelegate();
+
+	/** is async path request waiting for result? */
+	bool HasPendingPathRequest() const;
+
+	/** abort async path request waiting for result */
+	void AbortPendingPathRequest();
+
 	/** @return If this is a pawn return its location or the actor location */
 	virtual FVector GetAdjustLocation();
 
+	/** Same as MoveToLocation, but reuses paths found for other units when possible */
+	EPathFollowingRequestResult::Type MoveToLocationCached(const FVector& Dest, float AcceptanceRadius);
+
+	/** Same as MoveToActor, but reuses paths found for other units when possible */
+	EPathFollowingRequestResult::Type MoveToActorCached(AActor* Goal, float AcceptanceRadius);
+
+	/** get current level of detail tier */
+	EStrategyAILOD::Type GetLODTier() const;
+
 
 protected:
-	/** Check targets list and select one as current target */
+	/** Ask targeting subsystem to check targets list and select one as current target */
 	virtual void SelectTarget();
 
-protected:
-	/** array of controllers claimed this one as target */
-	TArray< TWeakObjectPtr<AStrategyAIController> > ClaimedBy;
+	/** Pick level of detail tier based on sensing results and distance to camera focal point */
+	void UpdateLODTier();
+
+	/** Start move using cached path if possible, regular pathfinding otherwise */
+	FPathFollowingRequestResult MoveWithPathCache(const FAIMoveRequest& MoveRequest);
 
+	/** Request path asynchronously, move starts when path is found */
+	FPathFollowingRequestResult MoveWithAsyncPath(const FAIMoveRequest& MoveRequest, const FStrategyPathCacheKey& CacheKey);
+
+	/** Async path request finished */
+	void OnAsyncPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+protected:
 	/** Event delegate for when pawn movement is complete. */
 	FOnMovementEvent OnMoveCompletedDelegate;
 
 	/** Event delegate for when pawn has hit something. */
 	FOnBumpEvent OnNotifyBumpDelegate;
 
+	/** Event delegate for when async path request finished. */
+	FOnPathEvent OnPathUpdatedDelegate;
+
+	/** If set, paths are requested asynchronously and moves start when result arrives */
+	UPROPERTY(config)
+	uint32 bDoAsyncPathfinding : 1;
+
+	/** id of async path request waiting for result */
+	uint32 PendingPathQueryId;
+
+	/** move request waiting for async path */
+	FAIMoveRequest PendingMoveRequest;
+
+	/** path cache key of move request waiting for async path */
+	FStrategyPathCacheKey PendingPathCacheKey;
+
 	/** master switch state */
 	uint8 bLogicEnabled : 1;
 
+	/** current level of detail tier */
+	TEnumAsByte<EStrategyAILOD::Type> LODTier;
+
+	/** world time of next decision when running at reduced rate */
+	float NextDecisionTime;
+
+	/** team registry of our world, cached for target validation */
+	UPROPERTY(Transient)
+	UStrategyTeamRegistry* TeamRegistry;
+
+private:
+	friend class UStrategyTargetingSubsystem;
+
+	/** slot in targeting subsystem */
+	int32 TargetingSlot;
+
 public:
 	/** Returns SensingComponent subobject **/
 	FORCEINLINE UStrategyAISensingComponent* GetSensingComponent() const { return SensingComponent; }
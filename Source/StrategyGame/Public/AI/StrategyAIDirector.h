@@ -9,6 +9,38 @@ class AStrategyBuilding_Brewery;
 class AStrategyChar;
 class UStrategyAttachment;
 
+UENUM()
+namespace EStrategySpawnMode
+{
+	enum Type
+	{
+		/** one minion every few seconds */
+		Cadence,
+		/** whole wave at once, spread over frames within time budget */
+		Batched,
+	};
+}
+
+/** Lateral offsets of spawn slots in front of brewery, handed out in fixed order from random first slot. */
+struct FStrategySpawnOffsets
+{
+	enum { NumOffsets = 6 };
+
+	/** offset of each slot */
+	float Offset[NumOffsets];
+
+	/** last slot handed out */
+	int32 LastIndex;
+
+	FStrategySpawnOffsets();
+
+	/** pick random slot to start from */
+	void Reset(FRandomStream& RandomStream);
+
+	/** get offset of next slot */
+	float GetOffset();
+};
+
 UCLASS()
 class UStrategyAIDirector : public UActorComponent
 {
@@ -39,6 +71,22 @@ class UStrategyAIDirector : public UActorComponent
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category=Minions)
 	float RadiusToSpawnOn;
 
+	/** Number of minions (with controllers) created up front in warmup, so waves reuse them instead of spawning */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category=Minions)
+	int32 PoolPrewarmSize;
+
+	/** How waves are spawned */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Minions)
+	TEnumAsByte<EStrategySpawnMode::Type> SpawnMode;
+
+	/** Max minions spawned in single frame in batched mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Minions, meta=(ClampMin = "1"))
+	int32 MaxSpawnsPerFrame;
+
+	/** Time budget for spawning in single frame in batched mode, in milliseconds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Minions, meta=(ClampMin = "0.1"))
+	float SpawnTimeBudget;
+
 protected:
 	/** default armor for spawns */
 	UPROPERTY()
@@ -70,9 +118,39 @@ public:
 	/** request spawn from AI Director */
 	void RequestSpawn();
 protected:
+	/** find nearest living brewery of enemy team */
+	AStrategyBuilding_Brewery* FindEnemyBrewery() const;
+
 	/** check conditions and spawn minions if possible */
 	void SpawnMinions();
 
+	/** fill actor pool with minions and their controllers */
+	void PrewarmMinionPool();
+
+	/** take minion from pool or spawn new one, and give it controller */
+	AStrategyChar* SpawnMinion(UClass* MinionClass, const FVector& Location, const FRotator& Rotation);
+
+	/** spawn whole wave: trace ground for all slots at once, then spawn within per frame limits */
+	void SpawnMinionsBatched();
+
+	/** spawn and set up single minion of wave */
+	bool SpawnMinionAt(const FVector& Loc);
+
+	/** get location of spawn slot in front of brewery, before ground is traced */
+	FVector GetSlotLocation(int32 SlotIdx);
+
+	/** seed random stream from match seed */
+	void InitRandomStream();
+
+	/** get ground trace for spawn slot */
+	void GetGroundTrace(const FVector& SlotLocation, FVector& OutStart, FVector& OutEnd) const;
+
+	/** get minion location for spawn slot, placed on ground if trace hit anything */
+	FVector GetSpawnLocation(const FVector& SlotLocation, const FHitResult& GroundHit) const;
+
+	/** async ground trace for spawn slot finished */
+	void OnGroundTraceDone(const FTraceHandle& Handle, FTraceDatum& Data);
+
 	/** Custom scale for spawns */
 	float CustomScale;
 
@@ -87,5 +165,36 @@ protected:
 
 	/** Brewery of my biggest enemy */
 	TWeakObjectPtr<AStrategyBuilding_Brewery> EnemyBrewery;
+
+	/** random stream for spawn offsets and timing */
+	FRandomStream SpawnRandom;
+
+	/** spawn slots generator */
+	FStrategySpawnOffsets OffsetsGenerator;
+
+	/** single minion of batched wave */
+	struct FPendingSpawn
+	{
+		/** slot location before ground trace */
+		FVector SlotLocation;
+
+		/** final spawn location */
+		FVector Location;
+
+		/** set when ground trace finished */
+		bool bGroundResolved;
+	};
+
+	/** minions of batched wave */
+	TArray<FPendingSpawn> PendingSpawns;
+
+	/** next minion of batched wave to spawn */
+	int32 NextPendingSpawn;
+
+	/** number of ground traces of batched wave still running */
+	int32 NumGroundTracesPending;
+
+	/** delegate of ground traces */
+	FTraceDelegate GroundTraceDelegate;
 };
 
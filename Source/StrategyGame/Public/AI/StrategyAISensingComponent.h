@@ -3,8 +3,43 @@
 #pragma once
 
 #include "Perception/PawnSensingComponent.h"
+#include "StrategySpatialGrid.h"
 #include "StrategyAISensingComponent.generated.h"
 
+/**
+ * Set of characters seen by sensor, keyed by spatial grid slot.
+ * Entries expire on their own when character leaves the grid (dies or is destroyed), so there is nothing to sweep.
+ */
+struct FStrategyKnownTargets
+{
+	FStrategyKnownTargets() : Grid(nullptr) {}
+
+	/** remember character, refreshes entry if its grid slot was seen before */
+	void Add(const UStrategySpatialGrid* InGrid, AStrategyChar* InChar);
+
+	/** forget all targets */
+	void Reset();
+
+	/** number of entries, including expired ones */
+	FORCEINLINE int32 Num() const { return Targets.Num(); }
+
+	/** get target at index, NULL if entry expired */
+	FORCEINLINE AStrategyChar* GetTarget(int32 Idx) const { return Grid != nullptr ? Grid->ResolveHandle(Targets[Idx]) : nullptr; }
+
+	/** get grid handle of entry at index */
+	FORCEINLINE const FStrategyGridHandle& GetHandle(int32 Idx) const { return Targets[Idx]; }
+
+private:
+	/** grid handles are resolved against */
+	const UStrategySpatialGrid* Grid;
+
+	/** known targets, one per grid slot */
+	TArray<FStrategyGridHandle> Targets;
+
+	/** grid slot to index in Targets */
+	TMap<int32, int32> SlotToTarget;
+};
+
 /**
  * SensingComponent encapsulates sensory (ie sight and hearing) settings and functionality for an Actor,
  * allowing the actor to see/hear Pawns in the world. It does *not* enable hearing and sight sensing by default.
@@ -16,6 +51,15 @@ class UStrategyAISensingComponent : public UPawnSensingComponent
 
 	virtual void InitializeComponent() override;
 
+	/** stop receiving updates from sensing scheduler */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Sensing updates are driven by UStrategyAISensingScheduler instead of timer on each component. */
+	virtual void SetSensingUpdatesEnabled(const bool bEnabled) override;
+
+	/** Change interval between sensing updates, picked up by scheduler on next update. */
+	virtual void SetSensingInterval(const float NewSensingInterval) override;
+
 	/** See if there are interesting sounds and sights that we want to detect, and respond to them if so. */
 	virtual void UpdateAISensing() override;
 
@@ -25,11 +69,29 @@ class UStrategyAISensingComponent : public UPawnSensingComponent
 	/** Are we capable of sensing anything (and do we have any callbacks that care about sensing)? If so, calls UpdateAISensing(). */
 	virtual bool CanSenseAnything() const;
 
-	/** list of known targets */
-	UPROPERTY()
-	TArray<TWeakObjectPtr<AActor>> KnownTargets;
+	/** Synchronous line of sight test from sensor to character. */
+	bool HasClearSightTo(const AStrategyChar* TestChar) const;
+
+	/** Character passed all sight checks, remember it as target. */
+	void OnTargetSeen(AStrategyChar* SeenChar);
+
+	/** Was any target seen in last two sensing updates? */
+	bool HasSeenTargetRecently() const;
+
+	/** Forget everything sensed so far, used when owner is recycled. */
+	void ForgetTargets();
+
+	/** set of known targets */
+	FStrategyKnownTargets KnownTargets;
 
 protected:
 	UPROPERTY(config)
 	float SightDistance;
+
+	/** world time when any target was seen last time */
+	float LastTargetSeenTime;
+
+	/** team registry of our world */
+	UPROPERTY(Transient)
+	class UStrategyTeamRegistry* TeamRegistry;
 };
@@ -0,0 +1,122 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyAISensingScheduler.generated.h"
+
+class UStrategyAISensingComponent;
+class AStrategyChar;
+
+/**
+ * Owns sensing updates of all AI sensing components in the world.
+ * Sensors are visited round-robin and updated when their interval passed, as long as the per frame time budget allows;
+ * the rest is deferred to next frame.
+ */
+UCLASS()
+class UStrategyAISensingScheduler : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyAISensingScheduler();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/**
+	 * Start scheduling sensing updates for component.
+	 *
+	 * @param	Sensor		The sensing component to register.
+	 */
+	void RegisterSensor(UStrategyAISensingComponent* Sensor);
+
+	/**
+	 * Stop scheduling sensing updates for component.
+	 *
+	 * @param	Sensor		The sensing component to unregister.
+	 */
+	void UnregisterSensor(UStrategyAISensingComponent* Sensor);
+
+	/**
+	 * Queue line of sight check, all checks of a frame are issued as one batch of async traces.
+	 * Target is reported back to sensor next frame if nothing blocks the sight.
+	 *
+	 * @param	Sensor		The sensing component asking for the check.
+	 * @param	Target		The character to check sight to.
+	 */
+	void QueueSightCheck(UStrategyAISensingComponent* Sensor, AStrategyChar* Target);
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** single registered sensor */
+	struct FScheduledSensor
+	{
+		/** sensing component, unregisters itself before it's gone */
+		UStrategyAISensingComponent* Sensor;
+
+		/** world time of next update */
+		float NextUpdateTime;
+	};
+
+	/** all registered sensors */
+	TArray<FScheduledSensor> Sensors;
+
+	/** sensor to start with in next frame */
+	int32 Cursor;
+
+	/** number of sensors unregistered during update, their entries are cleared and removed after it */
+	int32 NumRemoved;
+
+	/** are sensors being updated? */
+	bool bUpdatingSensors;
+
+	/** number of sensors registered so far, used to spread initial updates */
+	uint32 RegisterCounter;
+
+	/** single line of sight check */
+	struct FSightCheck
+	{
+		/** sensor waiting for the result */
+		TWeakObjectPtr<UStrategyAISensingComponent> Sensor;
+
+		/** checked character */
+		TWeakObjectPtr<AStrategyChar> Target;
+
+		/** trace start */
+		FVector Start;
+
+		/** trace end */
+		FVector End;
+	};
+
+	/** sight checks queued in current frame */
+	TArray<FSightCheck> QueuedSightChecks;
+
+	/** sight checks with traces in flight, double buffered by frame parity */
+	TArray<FSightCheck> PendingSightChecks[2];
+
+	/** parity of batch issued next */
+	uint32 SightBatchParity;
+
+	/** delegate called when async sight trace is done */
+	FTraceDelegate SightTraceDelegate;
+
+	/** remove entries of sensors unregistered during update */
+	void CompactSensors();
+
+	/** issue async traces for all queued sight checks */
+	void FlushSightChecks();
+
+	/** async sight trace finished */
+	void OnSightTraceDone(const FTraceHandle& Handle, FTraceDatum& Data);
+};
@@ -0,0 +1,184 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyFlowFieldSubsystem.generated.h"
+
+class ANavigationData;
+
+/**
+ * Goal directed flow fields over navmesh, one per goal actor (enemy brewery of each team).
+ * Field is a grid of navigable cells, each pointing to its neighbour closest to goal; it is requested by first query
+ * and rebuilt after buildings or navmesh change. Builds are spread over frames within time budget,
+ * previous field keeps answering queries until new one is finished.
+ */
+UCLASS(config=Game)
+class UStrategyFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyFlowFieldSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	// Begin UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	// End UWorldSubsystem interface
+
+	/** are flow fields enabled? */
+	static bool IsEnabled();
+
+	/**
+	 * Get direction to follow toward goal.
+	 *
+	 * @param	Goal			Actor to move to.
+	 * @param	Location		Current location of moving unit.
+	 * @param	OutDirection	Receives normalized 2D direction.
+	 * @returns	false if location is not covered by field or field is not built yet, caller should fall back to regular pathfinding.
+	 */
+	bool GetFlowDirection(const AActor* Goal, const FVector& Location, FVector& OutDirection);
+
+	/** mark all fields as outdated, builds in progress are restarted */
+	void InvalidateFields();
+
+	/** count pathfinding request issued by AI (not served from path cache) */
+	void NotifyPathRequest();
+
+	/** get number of path requests issued by AI */
+	FORCEINLINE int32 GetNumPathRequests() const { return NumPathRequests; }
+
+	/** get number of finished field builds */
+	FORCEINLINE int32 GetNumFieldBuilds() const { return NumFieldBuilds; }
+
+	/** get time spent building fields, in seconds */
+	FORCEINLINE double GetBuildSeconds() const { return BuildSeconds; }
+
+	/** get longest time spent building fields in single frame, in seconds */
+	FORCEINLINE double GetMaxBuildSliceSeconds() const { return MaxBuildSliceSeconds; }
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** Size of single field cell */
+	UPROPERTY(config)
+	float CellSize;
+
+	/** Max height difference between neighbouring cells */
+	UPROPERTY(config)
+	float MaxStepHeight;
+
+	/** field being built, kept apart from field answering queries */
+	struct FFlowFieldBuild
+	{
+		/** cell waiting in dijkstra open list */
+		struct FOpenCell
+		{
+			uint32 Cost;
+			int32 Index;
+
+			FOpenCell(uint32 InCost, int32 InIndex) : Cost(InCost), Index(InIndex) {}
+
+			bool operator<(const FOpenCell& Other) const { return Cost < Other.Cost; }
+		};
+
+		/** location of goal when build started */
+		FVector GoalLocation;
+
+		/** world location of cell (0,0) */
+		FVector2D Origin;
+
+		/** number of cells in each axis */
+		FIntPoint Size;
+
+		/** new neighbour index of each cell */
+		TArray<uint8> NextStep;
+
+		/** new navmesh height of each cell */
+		TArray<float> CellHeight;
+
+		/** navigable cells */
+		TBitArray<> Walkable;
+
+		/** cost of reaching goal from each cell */
+		TArray<uint32> Cost;
+
+		/** dijkstra open list */
+		TArray<FOpenCell> Open;
+
+		/** next cell to project to navmesh, all cells are projected before search starts */
+		int32 NextProjectedCell;
+
+		/** set when goal cell is known and search is running */
+		bool bSearching;
+	};
+
+	/** field toward single goal */
+	struct FFlowField
+	{
+		/** location of goal when field was built */
+		FVector GoalLocation;
+
+		/** world location of cell (0,0) */
+		FVector2D Origin;
+
+		/** number of cells in each axis */
+		FIntPoint Size;
+
+		/** neighbour index to move to for each cell, see NeighbourOffsets */
+		TArray<uint8> NextStep;
+
+		/** navmesh height of cell center */
+		TArray<float> CellHeight;
+
+		/** set when field needs rebuild */
+		bool bDirty;
+
+		/** build in progress, NULL if there's none */
+		TSharedPtr<FFlowFieldBuild> Build;
+	};
+
+	/** all fields, keyed by goal actor */
+	TMap<TWeakObjectPtr<const AActor>, FFlowField> Fields;
+
+	/** path requests issued by AI */
+	int32 NumPathRequests;
+
+	/** finished field builds */
+	int32 NumFieldBuilds;
+
+	/** time spent building fields */
+	double BuildSeconds;
+
+	/** longest time spent building fields in single frame */
+	double MaxBuildSliceSeconds;
+
+	/** start build of field toward goal */
+	void StartBuild(const AActor* Goal, FFlowField& Field);
+
+	/**
+	 * Continue field build.
+	 *
+	 * @param	Build		The build to continue.
+	 * @param	EndTime		Platform time at which build should yield, 0 to run until finished.
+	 * @returns	true if build is finished
+	 */
+	bool StepBuild(FFlowFieldBuild& Build, double EndTime) const;
+
+	/** get bounds fields are built in */
+	FBox GetFieldBounds() const;
+
+	/** navmesh was regenerated */
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+};
@@ -0,0 +1,120 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationData.h"
+#include "StrategyPathCacheSubsystem.generated.h"
+
+class AAIController;
+struct FAIMoveRequest;
+
+/** Key of cached path: start and goal navmesh polygons, plus goal actor for move to actor requests. */
+struct FStrategyPathCacheKey
+{
+	/** polygon path starts on */
+	NavNodeRef StartPoly;
+
+	/** polygon path ends on */
+	NavNodeRef GoalPoly;
+
+	/** actor we move to, if any */
+	TWeakObjectPtr<const AActor> GoalActor;
+
+	FStrategyPathCacheKey() : StartPoly(INVALID_NAVNODEREF), GoalPoly(INVALID_NAVNODEREF) {}
+
+	bool IsValid() const { return StartPoly != INVALID_NAVNODEREF && GoalPoly != INVALID_NAVNODEREF; }
+
+	bool operator==(const FStrategyPathCacheKey& Other) const
+	{
+		return StartPoly == Other.StartPoly && GoalPoly == Other.GoalPoly && GoalActor == Other.GoalActor;
+	}
+
+	friend uint32 GetTypeHash(const FStrategyPathCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.StartPoly), GetTypeHash(Key.GoalPoly)), GetTypeHash(Key.GoalActor));
+	}
+};
+
+/**
+ * Cache of path corridors for AI moves. Units spawned together start on the same navmesh polygons and head
+ * to the same goals, so they can share one pathfinding result.
+ * Cache is flushed whenever navmesh tiles are rebuilt.
+ */
+UCLASS(config=Game)
+class UStrategyPathCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyPathCacheSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	// End UWorldSubsystem interface
+
+	/** is path cache enabled? */
+	static bool IsEnabled();
+
+	/**
+	 * Look for cached path matching move request.
+	 *
+	 * @param	Querier		Controller which wants to move.
+	 * @param	MoveRequest	The move request.
+	 * @param	OutKey		Receives key of request, can be used to store path after cache miss.
+	 * @param	OutPath		Receives cached corridor string pulled from pawn location to goal, ready to use.
+	 * @returns	true on cache hit
+	 */
+	bool FindPath(const AAIController* Querier, const FAIMoveRequest& MoveRequest, FStrategyPathCacheKey& OutKey, FNavPathSharedPtr& OutPath);
+
+	/**
+	 * Store path found for request.
+	 *
+	 * @param	Key			Key returned by FindPath.
+	 * @param	Path		Path found by pathfinding.
+	 */
+	void AddPath(const FStrategyPathCacheKey& Key, FNavPathSharedPtr Path);
+
+	/** drop all cached paths */
+	void Flush();
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** How long cached path can be reused, in seconds */
+	UPROPERTY(config)
+	float MaxPathAge;
+
+	/** Max number of cached paths, cache is flushed when full */
+	UPROPERTY(config)
+	int32 MaxCachedPaths;
+
+	/** single cached path */
+	struct FCachedPath
+	{
+		/** navmesh polygons path goes through, string pulled again for each reuse and needed to detect invalidation of path */
+		TArray<NavNodeRef> PathCorridor;
+
+		/** cost of each polygon in corridor */
+		TArray<FVector::FReal> PathCorridorCost;
+
+		/** navigation data path was found on */
+		TWeakObjectPtr<const ANavigationData> NavData;
+
+		/** world time path was found */
+		float CreationTime;
+	};
+
+	/** all cached paths */
+	TMap<FStrategyPathCacheKey, FCachedPath> CachedPaths;
+
+	/** navmesh was regenerated */
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+};
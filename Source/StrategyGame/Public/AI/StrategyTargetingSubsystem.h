@@ -0,0 +1,152 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyTargetingSubsystem.generated.h"
+
+class AStrategyAIController;
+class AStrategyChar;
+struct FStrategyGridHandle;
+
+/** Candidate of target selection, already filtered by validity. */
+struct FStrategyTargetCandidate
+{
+	/** location of candidate */
+	FVector Location;
+
+	/** targeting slot of candidate's controller, INDEX_NONE if it's not controlled by AI */
+	int32 ControllerSlot;
+
+	/** candidate is current target of selecting controller */
+	bool bIsCurrentTarget;
+
+	/** selecting controller claimed candidate */
+	bool bClaimedByMe;
+};
+
+/**
+ * Selects targets for AI controllers and keeps their claims.
+ * Controllers get a slot when they possess a pawn; claims are kept in flat attacker -> target and target -> count tables indexed by slot,
+ * candidates are mapped to slots through their spatial grid slot instead of casting them to find their controller.
+ */
+UCLASS()
+class UStrategyTargetingSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyTargetingSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/**
+	 * Give controller a slot in claim tables.
+	 *
+	 * @param	InController	The controller to register.
+	 */
+	void RegisterController(AStrategyAIController* InController);
+
+	/**
+	 * Free controller's slot. Releases its claim on current target, its other claims keep being counted; claims on it are dropped.
+	 *
+	 * @param	InController	The controller to unregister.
+	 */
+	void UnregisterController(AStrategyAIController* InController);
+
+	/**
+	 * Select and apply target for controller, claims of earlier selections in the same frame are already counted.
+	 *
+	 * @param	InController	The controller which wants to select target.
+	 */
+	void SelectTarget(AStrategyAIController* InController);
+
+	/** add claim of attacker on target, attacker keeps its other claims */
+	void ClaimTarget(const AStrategyAIController* Attacker, const AStrategyAIController* Target);
+
+	/** release claim of attacker on target */
+	void UnClaimTarget(const AStrategyAIController* Attacker, const AStrategyAIController* Target);
+
+	/** check if attacker claimed target */
+	bool IsClaimedBy(const AStrategyAIController* Target, const AStrategyAIController* Attacker) const;
+
+	/** get number of attackers who claimed target */
+	int32 GetNumberOfAttackers(const AStrategyAIController* Target) const;
+
+	/**
+	 * Score single candidate target, lower is better.
+	 *
+	 * @param	DistSq				Squared distance to candidate.
+	 * @param	bIsCurrentTarget	Candidate is current target of scoring controller.
+	 * @param	bHasAIController	Candidate is controlled by AI, claims are only tracked for those.
+	 * @param	bClaimedByMe		Scoring controller already claimed candidate.
+	 * @param	NumAttackers		Number of controllers who claimed candidate.
+	 */
+	static float ScoreTarget(float DistSq, bool bIsCurrentTarget, bool bHasAIController, bool bClaimedByMe, int32 NumAttackers);
+
+	/**
+	 * Pick best scored candidate.
+	 *
+	 * @param	PawnLocation	Location of selecting pawn.
+	 * @param	Candidates		Valid candidates, in order of known targets.
+	 * @param	ClaimCounts		Number of attackers who claimed each slot.
+	 * @returns	index of best candidate, INDEX_NONE if there are no candidates
+	 */
+	static int32 PickTarget(const FVector& PawnLocation, TArrayView<const FStrategyTargetCandidate> Candidates, TArrayView<const int32> ClaimCounts);
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** controller in slot, NULL for free slots */
+	TArray<AStrategyAIController*> Controllers;
+
+	/** slot of target last claimed by controller in slot */
+	TArray<int32> AttackerToTarget;
+
+	/** number of attackers who claimed controller in slot */
+	TArray<int32> TargetClaimCount;
+
+	/** claims kept by attackers next to their last one (attacker slot, target slot), left when attacker lost its target without releasing the claim */
+	TArray<FIntPoint> ExtraClaims;
+
+	/** list of unused slots */
+	TArray<int32> FreeSlots;
+
+	/** controller slot of character in spatial grid slot, valid while grid serial matches */
+	struct FCharSlot
+	{
+		/** serial of grid slot when it was looked up */
+		uint32 Serial;
+
+		/** slot of character's controller, INDEX_NONE if it's not controlled by AI */
+		int32 ControllerSlot;
+
+		/** set once looked up, cleared when controller of character changes */
+		bool bValid;
+	};
+
+	/** controller slot of each spatial grid slot, filled on first lookup */
+	TArray<FCharSlot> CharToController;
+
+	/** get slot of controller, INDEX_NONE if not registered */
+	int32 GetSlot(const AStrategyAIController* InController) const;
+
+	/** get slot of character's controller, INDEX_NONE if it's not controlled by registered AI */
+	int32 GetCharSlot(const AStrategyChar* InChar, const FStrategyGridHandle& Handle);
+
+	/** forget cached controller slot of controller's pawn, its controller is changing */
+	void ResetCharSlot(const AStrategyAIController* InController);
+
+	/** check if attacker slot claimed target slot */
+	bool HasClaim(int32 AttackerSlot, int32 TargetSlot) const;
+
+	/** add claim of attacker slot on target slot, does nothing if it's already there */
+	void AddClaim(int32 AttackerSlot, int32 TargetSlot);
+
+	/** remove claim of attacker slot on target slot */
+	void RemoveClaim(int32 AttackerSlot, int32 TargetSlot);
+};
@@ -12,6 +12,7 @@
 DECLARE_DELEGATE_OneParam(FBuildFinishedDelegate, class AStrategyBuilding*);
 
 class AStrategyChar;
+class AStrategyProjectile;
 
 UCLASS(Abstract, Blueprintable)
 class AStrategyBuilding : public AActor,
@@ -19,15 +20,17 @@ class AStrategyBuilding : public AActor,
 {
 	GENERATED_UCLASS_BODY()
 
-	/** team */
+	/** team, 1 for player, 2 for enemy and above for additional AI teams */
 	UPROPERTY(EditInstanceOnly, Category=Building)
-	TEnumAsByte<EStrategyTeam::Type> SpawnTeamNum;
+	uint8 SpawnTeamNum;
 
 	/** multicast about finished construction */
 	FBuildFinishedDelegate BuildFinishedDelegate;
 
 	// Begin Actor interface
 	virtual void PostInitializeComponents() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Destroyed() override;
 	virtual void Tick(float DeltaTime) override;
 	virtual void PostLoad() override;
@@ -102,6 +105,9 @@ class AStrategyBuilding : public AActor,
 	/** Returns true if building process is finished, false otherwise. */
 	bool IsBuildFinished();
 
+	/** Building layout changed, AI flow fields need to be rebuilt. */
+	void InvalidateFlowFields();
+
 	//////////////////////////////////////////////////////////////////////////
 	// Reading data
 
@@ -125,6 +131,18 @@ class AStrategyBuilding : public AActor,
 	/** return cost needed to finish building */
 	float GetRemainingBuildCost() const;
 
+	/** add projectiles of given class to actor pool, done once when building fires for the first time */
+	void PrewarmProjectilePool(UClass* InProjectileClass);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Tower
+
+	/** is building a tower fired by tower targeting subsystem, instead of blueprint touch events? */
+	bool IsNativeTower() const;
+
+	/** shoot tower projectile at target, leading its movement */
+	void FireAtTarget(AStrategyChar* Target);
+
 protected:
 	/** construction start sound stinger */
 	UPROPERTY(EditDefaultsOnly, Category=Building)
@@ -166,6 +184,11 @@ private:
 	/** trigger box component */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Touch, meta = (AllowPrivateAccess = "true"))
 	UBoxComponent* TriggerBox;
+
+	/** index in tower targeting subsystem, INDEX_NONE if not registered */
+	int32 TowerIndex;
+
+	friend class UStrategyTowerTargetingSubsystem;
 protected:
 
 	/** affect friendly minions? */
@@ -202,6 +225,40 @@ protected:
 	/** remaining build time */
 	float RemainingBuildTime;
 
+	/** number of projectiles added to pool when building fires for the first time */
+	UPROPERTY(EditDefaultsOnly, Category=Building)
+	int32 ProjectilePoolPrewarmSize;
+
+	/** is projectile pool prewarmed for this building? */
+	uint8 bProjectilePoolPrewarmed : 1;
+
+	/** projectile fired by finished tower; if set, targets are picked natively and OnCharTouch is not sent, blueprint must not fire on its own */
+	UPROPERTY(EditDefaultsOnly, Category=Tower)
+	TSubclassOf<AStrategyProjectile> TowerProjectileClass;
+
+	/** time between two shots, targets are queried once per interval */
+	UPROPERTY(EditDefaultsOnly, Category=Tower)
+	float TowerFireInterval;
+
+	/** damage of single projectile */
+	UPROPERTY(EditDefaultsOnly, Category=Tower)
+	int32 TowerImpactDamage;
+
+	/** life span of fired projectiles */
+	UPROPERTY(EditDefaultsOnly, Category=Tower)
+	float TowerProjectileLifeSpan;
+
+	/** projectile spawn location, relative to building */
+	UPROPERTY(EditDefaultsOnly, Category=Tower)
+	FVector TowerMuzzleOffset;
+
+	/** how target is picked among enemies in trigger box */
+	UPROPERTY(EditDefaultsOnly, Category=Tower)
+	TEnumAsByte<EStrategyTowerTargeting::Type> TowerTargeting;
+
+	/** register finished tower in tower targeting subsystem */
+	void RegisterTower();
+
 	/** get data for current team */
 	struct FPlayerData* GetTeamData() const;
 
@@ -253,6 +310,10 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category=Building)
 	void OnBuildFinished();
 
+	/** blueprint event: tower fired projectile at target */
+	UFUNCTION(BlueprintImplementableEvent, Category=Tower)
+	void OnTowerFire(AStrategyChar* Target, AStrategyProjectile* Projectile);
+
 protected:
 	/** Returns TriggerBox subobject **/
 	FORCEINLINE UBoxComponent* GetTriggerBox() const { return TriggerBox; }
@@ -0,0 +1,80 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyTowerTargetingSubsystem.generated.h"
+
+class AStrategyBuilding;
+class AStrategyChar;
+class UStrategySpatialGrid;
+
+/**
+ * Picks targets for all finished towers and makes them fire.
+ * Every tower queries characters in spatial grid once per its fire interval; enemies inside its trigger box
+ * are ranked by tower's targeting policy and the best one is shot at.
+ * Towers opt in by setting TowerProjectileClass. Wall blueprints shipped with the game don't, they keep firing through their own graphs.
+ */
+UCLASS()
+class UStrategyTowerTargetingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyTowerTargetingSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** do towers fire natively, instead of through blueprint touch events? */
+	static bool IsEnabled();
+
+	/**
+	 * Start firing tower.
+	 *
+	 * @param	InTower		Finished tower, with projectile class set.
+	 */
+	void RegisterTower(AStrategyBuilding* InTower);
+
+	/**
+	 * Stop firing tower, must be called when it leaves play.
+	 *
+	 * @param	InTower		The tower to unregister.
+	 */
+	void UnregisterTower(AStrategyBuilding* InTower);
+
+	/** get number of registered towers */
+	int32 GetNumTowers() const;
+
+	/**
+	 * Find best target for tower.
+	 *
+	 * @param	Grid		Spatial grid with candidate characters.
+	 * @param	Index		Index of registered tower.
+	 * @returns	enemy to shoot at, NULL if there's none in range
+	 */
+	AStrategyChar* FindTarget(const UStrategySpatialGrid& Grid, int32 Index) const;
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** registered towers */
+	TArray<AStrategyBuilding*> Towers;
+
+	/** world time of next target query of each tower */
+	TArray<float> NextFireTimes;
+
+	/** world transform of trigger box of each tower */
+	TArray<FTransform> RangeTransforms;
+
+	/** scaled extent of trigger box of each tower */
+	TArray<FVector> RangeExtents;
+};
@@ -0,0 +1,23 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "StrategyPoolableInterface.generated.h"
+
+/** Interface for actors which can be recycled by actor pool instead of being destroyed */
+UINTERFACE()
+class UStrategyPoolableInterface : public UInterface
+{
+	GENERATED_UINTERFACE_BODY()
+};
+
+class IStrategyPoolableInterface
+{
+	GENERATED_IINTERFACE_BODY()
+
+	/** actor was returned to pool, stop everything it does and hide it */
+	virtual void OnPooled() = 0;
+
+	/** actor was taken from pool, restore state of freshly spawned actor */
+	virtual void OnUnpooled() = 0;
+};
@@ -4,13 +4,15 @@
 
 #include "StrategyTypes.h"
 #include "StrategyTeamInterface.h"
+#include "StrategyPoolableInterface.h"
 #include "StrategyChar.generated.h"
 
 class UStrategyAttachment;
+class UStrategySpatialGrid;
 
 // Base class for the minions
 UCLASS(Abstract)
-class AStrategyChar : public ACharacter, public IStrategyTeamInterface
+class AStrategyChar : public ACharacter, public IStrategyTeamInterface, public IStrategyPoolableInterface
 {
 	GENERATED_UCLASS_BODY()
 
@@ -30,6 +32,12 @@ public:
 	/** initial setup */
 	virtual void PostInitializeComponents() override;
 
+	/** register in spatial grid and health regen */
+	virtual void BeginPlay() override;
+
+	/** remove from spatial grid and health regen */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
 	 * Kills pawn.
 	 * @param KillingDamage - Damage amount of the killing blow
@@ -49,21 +57,29 @@ public:
 	/** don't export collisions for navigation */
 	virtual bool IsComponentRelevantForNavigation(UActorComponent* Component) const override { return false; }
 
-	/** Take damage, handle death */
+	/** Take damage right away through combat subsystem, handle death */
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	/** send damage events for damage applied by combat subsystem, the same ones AActor::TakeDamage sends */
+	void NotifyDamageTaken(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
+
 	/** pass hit notifies to AI */
 	virtual void NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalForce, const FHitResult& Hit) override;
 
 	virtual uint8 GetTeamNum() const override;
 
+	// Begin IStrategyPoolableInterface interface
+	virtual void OnPooled() override;
+	virtual void OnUnpooled() override;
+	// End IStrategyPoolableInterface interface
+
 	/** 
 	 * Starts melee attack. 
 	 * @return Duration of the attack anim.
 	 */
 	float PlayMeleeAnim();
 
-	/** Notification triggered from the melee animation to signal impact. */
+	/** Notification triggered from the melee animation to signal impact, queues hit in combat subsystem. */
 	void OnMeleeImpactNotify();
 
 	/** set attachment for weapon slot */
@@ -80,6 +96,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category=Attachment)
 	bool IsArmorAttached();
 
+	/** take attachment of given class kept from previous life of pooled character, NULL if there is none */
+	UStrategyAttachment* TakePooledAttachment(TSubclassOf<UStrategyAttachment> AttachmentClass);
+
 	/** set team number */
 	void SetTeamNum(uint8 NewTeamNum); 
 
@@ -117,6 +136,10 @@ protected:
 	UPROPERTY()
 	UStrategyAttachment* WeaponSlot;
 
+	/** Attachments removed when character was pooled, ready to be given again */
+	UPROPERTY()
+	TArray<UStrategyAttachment*> PooledAttachments;
+
 	/** team number */
 	uint8 MyTeamNum;
 
@@ -127,23 +150,33 @@ protected:
 	/** pawn data with added buff effects */
 	FPawnData ModifiedPawnData;
 
-	/** List of active buffs */
-	TArray<struct FBuffData> ActiveBuffs;
+	/** Base walk speed, buff speed modifiers are added to it */
+	float BaseWalkSpeed;
+
+	/** Base max health from class defaults, buff max health bonus is added to it */
+	int32 BaseMaxHealth;
 
 	/** update pawn data after changes in active buffs */
 	void UpdatePawnData();
 
-	/** update pawn's health */
-	void UpdateHealth();
-
-	/** event called after die animation  to hide character and delete it asap */
+	/** event called after die animation to hide character and delete or pool it asap */
 	void OnDieAnimationEnd();
 
+	/** take damage one hit at a time through game mode rules, used when damage batching is disabled */
+	float TakeDamageUnbatched(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser);
+
 private:
-	/** Handle for efficient management of UpdatePawnData timer */
-	FTimerHandle TimerHandle_UpdatePawnData;
+	friend class UStrategySpatialGrid;
+	friend class UStrategyBuffSubsystem;
+	friend class UStrategyHealthRegenSubsystem;
+
+	/** index of this character in spatial grid, INDEX_NONE if not registered */
+	int32 SpatialGridIndex;
+
+	/** first entry of this character's buffs in buff subsystem, INDEX_NONE if there are none */
+	int32 BuffListHead;
 
-	/** Handle for efficient management of UpdateHealth timer */
-	FTimerHandle TimerHandle_UpdateHealth;
+	/** index of this character in health regen subsystem, INDEX_NONE if not registered */
+	int32 HealthRegenIndex;
 };
 
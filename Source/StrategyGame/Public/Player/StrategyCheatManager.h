@@ -16,4 +16,12 @@ class UStrategyCheatManager : public UCheatManager
 	 */
 	UFUNCTION(exec)
 	void AddGold(uint32 NewGold);
+
+	/**
+	 * Spawn big enemy wave at once, using batched spawning.
+	 *
+	 * @param NumMinions	Number of minions in wave.
+	 */
+	UFUNCTION(exec)
+	void StressWave(int32 NumMinions);
 };
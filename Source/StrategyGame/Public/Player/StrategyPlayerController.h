@@ -17,6 +17,9 @@ public:
 	/** fixed rotation */
 	virtual void UpdateRotation(float DeltaTime) override;
 
+	/** publishes camera focal location for AI level of detail */
+	virtual void UpdateCameraManager(float DeltaSeconds) override;
+
 protected:
 	/** update input detection */
 	virtual void SetupInputComponent() override;
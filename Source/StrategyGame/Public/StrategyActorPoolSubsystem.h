@@ -0,0 +1,73 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyActorPoolSubsystem.generated.h"
+
+/**
+ * Pools of inactive actors, one per class. Actors implementing IStrategyPoolableInterface are returned here
+ * instead of being destroyed and handed out again in place of spawning new ones.
+ */
+UCLASS()
+class UStrategyActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyActorPoolSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** is pooling enabled? */
+	static bool IsEnabled();
+
+	/**
+	 * Take actor from pool, or spawn new one when pool is empty.
+	 * Collisions are not checked at given location, same as ESpawnActorCollisionHandlingMethod::AlwaysSpawn.
+	 *
+	 * @param	ActorClass	Class of actor.
+	 * @param	Location	Location to place actor at.
+	 * @param	Rotation	Rotation of actor.
+	 * @returns	active actor, or null if spawn failed
+	 */
+	AActor* AcquireActor(UClass* ActorClass, const FVector& Location, const FRotator& Rotation);
+
+	template<class T>
+	T* AcquireActor(UClass* ActorClass, const FVector& Location, const FRotator& Rotation)
+	{
+		return Cast<T>(AcquireActor(ActorClass, Location, Rotation));
+	}
+
+	/**
+	 * Return actor to pool.
+	 *
+	 * @param	Actor		Actor to return.
+	 * @returns	false if actor can't be pooled, caller should destroy it
+	 */
+	bool ReleaseActor(AActor* Actor);
+
+	/**
+	 * Make sure pool of given class holds at least Count inactive actors.
+	 *
+	 * @param	ActorClass	Class of actor.
+	 * @param	Count		Number of inactive actors to keep ready.
+	 */
+	void Prewarm(UClass* ActorClass, int32 Count);
+
+	/** get number of inactive actors of given class */
+	int32 GetNumPooled(UClass* ActorClass) const;
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** spawn new active actor */
+	AActor* SpawnActor(UClass* ActorClass, const FVector& Location, const FRotator& Rotation) const;
+
+	/** inactive actors, keyed by class */
+	TMap<TWeakObjectPtr<UClass>, TArray<TWeakObjectPtr<AActor>>> Pools;
+};
@@ -0,0 +1,119 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyTypes.h"
+#include "StrategyBuffSubsystem.generated.h"
+
+class AStrategyChar;
+
+/**
+ * Active buffs of all characters, stored in one flat pool with per character lists.
+ * Timed buffs are tracked by single expiry heap; characters recompute their stats only when their own buffs change.
+ */
+UCLASS()
+class UStrategyBuffSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyBuffSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/**
+	 * Add buff to character. Caller is responsible for updating character's stats.
+	 *
+	 * @param	InChar		The character to buff.
+	 * @param	Buff		The buff to add, end time is calculated from its duration.
+	 */
+	void AddBuff(AStrategyChar* InChar, const FBuffData& Buff);
+
+	/**
+	 * Remove all buffs of character, used when it leaves play or is pooled.
+	 *
+	 * @param	InChar		The character to clear.
+	 */
+	void RemoveAllBuffs(AStrategyChar* InChar);
+
+	/**
+	 * Add effects of all buffs active on character.
+	 *
+	 * @param	InChar		The character to check.
+	 * @param	PawnData	Data to add buff effects to.
+	 */
+	void AccumulateBuffs(const AStrategyChar* InChar, FPawnData& PawnData) const;
+
+	/**
+	 * Remove buffs which ended before given time and update their characters.
+	 *
+	 * @param	CurrentTime		World time to check against.
+	 * @returns	number of characters updated
+	 */
+	int32 ExpireBuffs(float CurrentTime);
+
+	/** get number of active buffs */
+	int32 GetNumBuffs() const;
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** single active buff */
+	struct FBuffEntry
+	{
+		/** buffed character, NULL for free entry */
+		AStrategyChar* Char;
+
+		/** buff, with end time set */
+		FBuffData Buff;
+
+		/** next buff of the same character */
+		int32 Next;
+
+		/** previous buff of the same character */
+		int32 Prev;
+
+		/** changed every time entry is reused, to detect stale heap entries */
+		uint32 Serial;
+	};
+
+	/** expiry of timed buff */
+	struct FBuffExpiry
+	{
+		/** world time when buff ends */
+		float EndTime;
+
+		/** buff entry */
+		int32 EntryIndex;
+
+		/** serial of entry when buff was added */
+		uint32 Serial;
+
+		bool operator<(const FBuffExpiry& Other) const { return EndTime < Other.EndTime; }
+	};
+
+	/** all buff entries */
+	TArray<FBuffEntry> Entries;
+
+	/** indices of free entries */
+	TArray<int32> FreeEntries;
+
+	/** min-heap of buff expiry times */
+	TArray<FBuffExpiry> ExpiryHeap;
+
+	/** characters which lost buffs during current expiry pass */
+	TSet<AStrategyChar*> ExpiredChars;
+
+	/** unlink buff from its character and free entry */
+	void RemoveEntry(int32 EntryIndex);
+};
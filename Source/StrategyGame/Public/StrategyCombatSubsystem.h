@@ -0,0 +1,188 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyCombatSubsystem.generated.h"
+
+class AStrategyChar;
+class UStrategySpatialGrid;
+class UStrategyTeamRegistry;
+
+/**
+ * Resolves melee attacks and damage of all characters once per frame. Impacts signalled by melee animations are queued,
+ * their victims are found with box test against characters in spatial grid.
+ * Damage is collected in one buffer and goes through game rules, health changes and death and stat events in separate passes.
+ */
+UCLASS()
+class UStrategyCombatSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyCombatSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** is damage collected and resolved in batches? If not, characters take every hit right away through game mode rules */
+	static bool IsEnabled();
+
+	/**
+	 * Queue melee impact, resolved at end of frame.
+	 *
+	 * @param	Attacker	The attacking character, hit box is taken from its current location and rotation.
+	 * @param	Damage		Damage dealt to first enemy in hit box.
+	 */
+	void QueueMeleeImpact(AStrategyChar* Attacker, int32 Damage);
+
+	/** resolve all queued melee impacts and queue their damage */
+	void ResolveMeleeImpacts();
+
+	/** get number of melee impacts waiting for resolution */
+	int32 GetNumPendingMeleeImpacts() const;
+
+	/**
+	 * Queue damage to character, applied at end of frame together with all other queued damage.
+	 *
+	 * @param	Victim		The damaged character.
+	 * @param	Damage		Damage before game rules and damage reduction.
+	 * @param	DamageEvent	Damage event, point damage keeps its hit info for victim's damage events.
+	 * @param	Instigator	The controller responsible for damage, can be NULL.
+	 * @param	Causer		The actor that directly caused damage, can be NULL.
+	 */
+	void QueueDamage(AStrategyChar* Victim, float Damage, struct FDamageEvent const& DamageEvent, AController* Instigator, AActor* Causer);
+
+	/** apply all queued damage */
+	void FlushDamage();
+
+	/**
+	 * Apply damage to character right away, with the same rules as queued damage. Used by TakeDamage.
+	 *
+	 * @param	Victim		The damaged character.
+	 * @param	Damage		Damage before game rules and damage reduction.
+	 * @param	DamageEvent	Damage event, passed to damage events and death of victim.
+	 * @param	Instigator	The controller responsible for damage, can be NULL.
+	 * @param	Causer		The actor that directly caused damage, can be NULL.
+	 * @returns	damage taken by victim
+	 */
+	float ApplyDamage(AStrategyChar* Victim, float Damage, struct FDamageEvent const& DamageEvent, AController* Instigator, AActor* Causer);
+
+	/** get number of damage events waiting for flush */
+	int32 GetNumPendingDamage() const;
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** queued melee impact */
+	struct FMeleeRequest
+	{
+		/** attacking character */
+		AStrategyChar* Attacker;
+
+		/** controller of attacker at time of impact */
+		AController* Instigator;
+
+		/** damage of the blow */
+		int32 Damage;
+
+		/** start of hit box sweep */
+		FVector Start;
+
+		/** direction of hit box sweep */
+		FVector Dir;
+
+		/** length of hit box sweep */
+		float Distance;
+	};
+
+	/** resolved melee hit, waiting for damage */
+	struct FMeleeHit
+	{
+		/** hit info passed with damage event */
+		FHitResult Hit;
+
+		/** request which caused hit */
+		int32 RequestIndex;
+	};
+
+	/** single damage event */
+	struct FDamageEntry
+	{
+		/** damaged character */
+		AStrategyChar* Victim;
+
+		/** controller responsible for damage */
+		AController* Instigator;
+
+		/** actor that directly caused damage */
+		AActor* Causer;
+
+		/** damage, reduced by game rules during flush */
+		float Damage;
+
+		/** team of victim */
+		uint8 VictimTeam;
+
+		/** team of instigator, or of causer when instigator has none; used for friendly fire */
+		uint8 AttackerTeam;
+
+		/** team of instigator, credited with damage done */
+		uint8 InstigatorTeam;
+
+		/** damage type of event */
+		TSubclassOf<UDamageType> DamageTypeClass;
+
+		/** index of point damage event with hit info, INDEX_NONE for damage without one */
+		int32 PointDamageIndex;
+	};
+
+	/** team registry of this world, used to cache teams of damage entries */
+	UPROPERTY(Transient)
+	UStrategyTeamRegistry* TeamRegistry;
+
+	/** melee impacts queued this frame */
+	TArray<FMeleeRequest> MeleeRequests;
+
+	/** hits of current resolution pass */
+	TArray<FMeleeHit> MeleeHits;
+
+	/** damage queued this frame */
+	TArray<FDamageEntry> DamageQueue;
+
+	/** damage being flushed, damage queued by its events waits for next flush */
+	TArray<FDamageEntry> DamageBatch;
+
+	/** point damage events of queued damage, kept apart so entries stay small */
+	TArray<FPointDamageEvent> PointDamageQueue;
+
+	/** point damage events of damage being flushed */
+	TArray<FPointDamageEvent> PointDamageBatch;
+
+	/** fill damage entry and cache teams of its actors */
+	void InitDamageEntry(FDamageEntry& Entry, AStrategyChar* Victim, float Damage, struct FDamageEvent const& DamageEvent, AController* Instigator, AActor* Causer) const;
+
+	/**
+	 * Run damage entries through game rules, apply them to health and send damage, death and stat events.
+	 *
+	 * @param	Entries				Damage entries to resolve.
+	 * @param	NumEntries			Number of entries.
+	 * @param	PointDamageEvents	Point damage events referenced by entries, can be NULL if there are none.
+	 */
+	void ResolveDamage(FDamageEntry* Entries, int32 NumEntries, const FPointDamageEvent* PointDamageEvents);
+
+	/** find first enemy in hit box among characters registered in grid */
+	bool FindVictimInGrid(const UStrategySpatialGrid& Grid, const FMeleeRequest& Request, FHitResult& OutHit) const;
+
+	/** find first enemy in hit box with physics sweep */
+	bool FindVictimBySweep(const FMeleeRequest& Request, FHitResult& OutHit) const;
+};
@@ -16,6 +16,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogGame, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("StrategyAI"), STATGROUP_StrategyAI, STATCAT_Advanced);
+
 /** 
     when you modify this, please note that this information can be saved with instances also DefaultEngine.ini 
     [/Script/Engine.CollisionProfile] should match with this list 
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "StrategyTypes.h"
+#include "StrategyTeamRegistry.h"
 #include "StrategyGameMode.generated.h"
 
 class AController;
@@ -24,12 +25,27 @@ class AStrategyGameMode : public AGameModeBase
 
 	/** Name of the difficulty param on the URL options string. */
 	static const FString DifficultyOptionName;
+
+	/** Name of the random seed param on the URL options string. */
+	static const FString SeedOptionName;
+
+	/** Name of the fast forward param on the URL options string, optional value is fixed simulation step in seconds. */
+	static const FString FastForwardOptionName;
+
+	/** Name of the number of teams param on the URL options string. */
+	static const FString TeamsOptionName;
 	
 	// Begin GameMode interface
 
 	/** Initialize the GameState actor. */
 	virtual void InitGameState() override;
 
+	/** Start fast forward if requested on URL. */
+	virtual void StartPlay() override;
+
+	/** Restore real time simulation. */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** 
 	 * Handle new player, skips pawn spawning. 
 	 * @param NewPlayer	
@@ -37,7 +53,8 @@ class AStrategyGameMode : public AGameModeBase
 	virtual void RestartPlayer(AController* NewPlayer) override;
 	
 	/** 
-	 * Modify the damage we want to apply to an actor.
+	 * Modify the damage we want to apply to an actor. Only used when damage batching is disabled,
+	 * combat subsystem applies the same rules to batched damage.
 	 * 
 	  * @param Damage			The damage
 	  * @param DamagedActor		The actor we wish to damage
@@ -81,6 +98,14 @@ class AStrategyGameMode : public AGameModeBase
 	 */	
 	static bool OnEnemyTeam(const AActor* ActorA, const AActor* ActorB);
 
+	/** 
+	 * Helper function to get relation of actors' teams, uses team registry of ActorA's world when available.
+	 *
+	 * @param ActorA		First actor to test against
+	 * @param ActorB		Second actor to test against
+	 */
+	static EStrategyTeamRelation::Type GetTeamRelation(const AActor* ActorA, const AActor* ActorB);
+
 	/** Helper method for UI, to exit game. */
 	void ExitGame();
 
@@ -93,6 +118,28 @@ protected:
 
 	/** Handle for efficient management of UpdateHealth timer */
 	FTimerHandle TimerHandle_ReturnToMenu;
+
+	/** 
+	 * Step world at fixed delta as fast as possible, without rendering and audio.
+	 *
+	 * @param	TimeStep	Simulation step in seconds.
+	 */
+	void StartFastForward(float TimeStep);
+
+	/** Return to real time simulation. */
+	void StopFastForward();
+
+	/** Log simulated time against real time since fast forward started. */
+	void ReportFastForward() const;
+
+	/** Game time when fast forward started. */
+	float FastForwardStartTime;
+
+	/** Real time when fast forward started. */
+	double FastForwardStartRealTime;
+
+	/** r.VSync before fast forward started, restored when it stops. */
+	int32 SavedVSync;
 };
 
 
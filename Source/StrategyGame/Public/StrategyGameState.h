@@ -7,6 +7,7 @@
 #include "StrategyGameState.generated.h"
 
 class AStrategyChar;
+class AStrategyBuilding;
 /*class AStrategyMiniMapCapture;*/
 
 UCLASS(config=Game)
@@ -24,10 +25,23 @@ public:
 	/** World bounds for mini map & camera movement. */
 	FBox WorldBounds;
 
+	/** Location player camera is looking at, updated by camera component. */
+	FVector CameraFocalLocation;
+
+	/** Set once camera reported its focal location. */
+	uint8 bHasCameraFocalLocation : 1;
+
+	/** Set while game mode steps simulation at fixed delta, decoupled from wall time. */
+	uint8 bFastForward : 1;
+
 	/** Warm up time before game starts */
 	UPROPERTY(config)
 	int32 WarmupTime;
 
+	/** Number of teams including neutral one, teams after EStrategyTeam::Enemy are additional AI teams */
+	UPROPERTY(config)
+	int32 NumTeams;
+
 	/** Current difficulty level of the game. */
 	EGameDifficulty::Type GameDifficulty;
 
@@ -63,11 +77,19 @@ public:
 	void OnCharSpawned(AStrategyChar* InChar);
 
 	/** 
-	 * Notification that an actor was damaged. 
+	 * Add damage done by team, reported once per damage batch.
 	 * 
-	 * @param	InChar	The character that has died.
+	 * @param	TeamNum	The team that inflicted the damage.
 	 * @param	Damage	The amount of damage inflicted.
-	 * @param	InChar	The controller that inflicted the damage.
+	 */
+	void AddDamageDone(uint8 TeamNum, int32 Damage);
+
+	/** 
+	 * Notification that an actor was damaged, used when damage batching is disabled.
+	 * 
+	 * @param	InActor			The damaged actor.
+	 * @param	Damage			The amount of damage inflicted.
+	 * @param	EventInstigator	The controller that inflicted the damage.
 	 */
 	void OnActorDamaged(AActor* InActor, float Damage, AController* EventInstigator);
 	
@@ -79,6 +101,33 @@ public:
 	 */
 	FPlayerData* GetPlayerData(uint8 TeamNum) const;
 
+	/** 
+	 * Size per team data for this match, must be called before any team is assigned.
+	 * 
+	 * @param	InNumTeams	Number of teams including neutral one.
+	 */
+	void InitTeams(int32 InNumTeams);
+
+	/** Get number of teams including neutral one */
+	int32 GetNumTeams() const;
+
+	/** 
+	 * Track building of any team until its construction finishes.
+	 * 
+	 * @param	InBuilding	The building waiting for construction.
+	 */
+	void AddUnfinishedBuilding(AStrategyBuilding* InBuilding);
+
+	/** 
+	 * Stop tracking building once it's constructed or destroyed.
+	 * 
+	 * @param	InBuilding	The building to remove.
+	 */
+	void RemoveUnfinishedBuilding(AStrategyBuilding* InBuilding);
+
+	/** Get buildings of all teams which are not constructed yet */
+	const TArray<TWeakObjectPtr<AStrategyBuilding>>& GetUnfinishedBuildings() const;
+
 	/** 
 	 * Initialize the game-play state machine. 
 	 */
@@ -111,6 +160,19 @@ public:
 	/** Get time when game finished */
 	float GetGameFinishedTime() const;
 
+	/** 
+	 * Set seed of this match and reset random streams derived from it.
+	 *
+	 * @param	Seed	The match seed.
+	 */
+	void InitMatchSeed(int32 Seed);
+
+	/** Get seed of this match, all gameplay random streams are derived from it */
+	int32 GetMatchSeed() const;
+
+	/** Get random stream for combat rolls */
+	FRandomStream& GetCombatRandom();
+
 	/** 
 	 * Set current difficulty level of the game. 
 	 *
@@ -124,7 +186,10 @@ protected:
 	mutable TArray<FPlayerData> PlayersData;
 
 	/** Count of live pawns for each team */
-	uint32 LivePawnCounter[EStrategyTeam::MAX];
+	TArray<uint32> LivePawnCounter;
+
+	/** Buildings of all teams which are not constructed yet */
+	TArray<TWeakObjectPtr<AStrategyBuilding>> UnfinishedBuildings;
 
 	/** Team that won.  Set at end of game. */
 	EStrategyTeam::Type WinningTeam;
@@ -132,6 +197,12 @@ protected:
 	/** Time in seconds when the game finished. Set at the end of game. */
 	float GameFinishedTime;
 
+	/** Seed of this match. */
+	int32 MatchSeed;
+
+	/** Random stream for combat rolls. */
+	FRandomStream CombatRandom;
+
 	/** Handle for efficient management of UpdateHealth timer */
 	FTimerHandle TimerHandle_OnGameStart;
 
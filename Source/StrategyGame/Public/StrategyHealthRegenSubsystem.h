@@ -0,0 +1,83 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyHealthRegenSubsystem.generated.h"
+
+class AStrategyChar;
+
+/**
+ * Health regeneration and damage over time of all living characters, kept in dense arrays.
+ * Every character is updated once per regen interval, with updates spread evenly over frames.
+ */
+UCLASS()
+class UStrategyHealthRegenSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyHealthRegenSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/**
+	 * Start updating health of character.
+	 *
+	 * @param	InChar		The character to register, must be alive.
+	 */
+	void RegisterChar(AStrategyChar* InChar);
+
+	/**
+	 * Stop updating health of character, must be called when it dies or leaves play.
+	 *
+	 * @param	InChar		The character to unregister.
+	 */
+	void UnregisterChar(AStrategyChar* InChar);
+
+	/**
+	 * Copy current health regen and max health of character, needs to be called whenever its pawn data changes.
+	 *
+	 * @param	InChar		The character to update.
+	 */
+	void UpdateChar(const AStrategyChar* InChar);
+
+	/** get number of registered characters */
+	int32 GetNumChars() const;
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** time between two updates of the same character */
+	float RegenInterval;
+
+	/** registered characters */
+	TArray<AStrategyChar*> Chars;
+
+	/** health regen of each character, negative for damage over time */
+	TArray<int32> HealthRegen;
+
+	/** max health of each character */
+	TArray<int32> MaxHealth;
+
+	/** next character to update */
+	int32 NextIndex;
+
+	/** fraction of character update carried over to next frame */
+	float PendingUpdates;
+
+	/** update next NumUpdates characters, wrapping around */
+	void UpdateChars(int32 NumUpdates);
+
+	/** swap two registered characters with their data */
+	void SwapChars(int32 IndexA, int32 IndexB);
+};
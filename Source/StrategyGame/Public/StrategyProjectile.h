@@ -3,14 +3,16 @@
 #pragma once
 
 #include "StrategyTeamInterface.h"
+#include "StrategyPoolableInterface.h"
 #include "StrategyProjectile.generated.h"
 
 class AActor;
 class AStrategyBuilding;
+class AStrategyChar;
 
 // Base class for the projectiles in the game
 UCLASS(Blueprintable)
-class AStrategyProjectile : public AActor, public IStrategyTeamInterface
+class AStrategyProjectile : public AActor, public IStrategyTeamInterface, public IStrategyPoolableInterface
 {
 	GENERATED_UCLASS_BODY()
 
@@ -22,6 +24,11 @@ private:
 	/** collisions */
 	UPROPERTY(VisibleDefaultsOnly, Category=Projectile)
 	USphereComponent* CollisionComp;
+
+	/** slot in projectile subsystem, INDEX_NONE when moved by movement component */
+	int32 SimIndex;
+
+	friend class UStrategyProjectileSubsystem;
 public:
 
 	/** type of damage */
@@ -35,7 +42,7 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category=Damage)
 	bool ConstantDamage;
 
-	/** initial setup */
+	/** initial setup, also for projectiles taken from pool */
 	void InitProjectile(const FVector& ShootDirection, uint8 InTeamNum, int32 ImpactDamage, float InLifeSpan);
 
 	/** blueprint event: projectile hit something */
@@ -50,8 +57,18 @@ public:
 	UFUNCTION()
 	void OnHit(const FHitResult& HitResult);
 
+	/** bind movement events */
+	virtual void PostInitializeComponents() override;
+
+	/** stop simulation of projectile */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** projectile is deactivated when its lifespan ends */
 	virtual void LifeSpanExpired() override;
 
+	/** blueprints destroy projectiles after hit, return them to pool instead */
+	virtual void K2_DestroyActor() override;
+
 	/** handle touch to detect enemy pawns */
 	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
 
@@ -63,20 +80,34 @@ public:
 	/** [IStrategyTeamInterface] get team number */
 	virtual uint8 GetTeamNum() const override;
 
+	// Begin IStrategyPoolableInterface interface
+	virtual void OnPooled() override;
+	virtual void OnUnpooled() override;
+	// End IStrategyPoolableInterface interface
+
 protected:
 	/** deal damage */
 	void DealDamage(FHitResult const& HitResult);
 
+	/** hit enemy character once, with impact at given location */
+	void HitChar(AStrategyChar* InChar, const FVector& HitLocation, const FVector& HitDir);
+
+	/** send destroyed event, then return projectile to pool or destroy it */
+	void DeactivateProjectile();
+
+	/** return active projectile to pool, false if it can't be pooled */
+	bool ReleaseToPool();
+
 	/** current team number */
 	uint8 MyTeamNum;
 
 	/** remaining damage value */
 	int32 RemainingDamage;
 
-	/** list of just hit actors */
-	TArray<AActor*> HitActors;
+	/** unique ids of already hit actors, piercing projectiles rarely hit more than a few */
+	TSet<uint32, DefaultKeyFuncs<uint32>, TInlineSetAllocator<8>> HitActorIds;
 
-	/** true, if projectile was initialized */
+	/** true, if projectile was initialized and is not pooled */
 	bool bInitialized;
 
 public:
@@ -0,0 +1,96 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyProjectileSubsystem.generated.h"
+
+class AStrategyProjectile;
+
+/**
+ * Flight of all projectiles, simulated in dense arrays instead of per actor movement components.
+ * Hits are tested against characters in spatial grid and against static geometry with async line traces,
+ * requested one frame ahead along predicted path. Projectile actors only follow simulated location and fire hit events;
+ * with Strategy.Projectiles.MoveActors 0 they are moved only to their hits, for headless runs.
+ */
+UCLASS()
+class UStrategyProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyProjectileSubsystem();
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** are projectiles simulated here? */
+	static bool IsEnabled();
+
+	/**
+	 * Start simulating projectile, its movement component stops ticking.
+	 *
+	 * @param	Projectile	Initialized projectile, moving with velocity of its movement component.
+	 */
+	void AddProjectile(AStrategyProjectile* Projectile);
+
+	/**
+	 * Stop simulating projectile, projectile stays at its simulated location.
+	 *
+	 * @param	Projectile	The projectile to remove.
+	 */
+	void RemoveProjectile(AStrategyProjectile* Projectile);
+
+	/** get number of simulated projectiles */
+	int32 GetNumProjectiles() const;
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** simulated projectiles, NULL for removed ones until arrays are compacted */
+	TArray<AStrategyProjectile*> Projectiles;
+
+	/** location of each projectile */
+	TArray<FVector> Locations;
+
+	/** velocity of each projectile */
+	TArray<FVector> Velocities;
+
+	/** team of each projectile */
+	TArray<uint8> Teams;
+
+	/** static geometry trace requested last frame from current location */
+	TArray<FTraceHandle> TraceHandles;
+
+	/** length of requested trace */
+	TArray<float> TraceLengths;
+
+	/** location of each projectile at start of current frame */
+	TArray<FVector> PrevLocations;
+
+	/** number of removed projectiles waiting for compaction */
+	int32 NumRemoved;
+
+	/** length of last frame, used to predict path of next one */
+	float LastDeltaTime;
+
+	/** remove slots of removed projectiles, keeping arrays dense */
+	void Compact();
+
+	/** advance projectile in slot, firing its hits; actor is moved along only if bMoveActor is set */
+	void UpdateProjectile(int32 Slot, bool bMoveActor);
+
+	/** find static geometry hit on path of projectile in slot */
+	bool FindStaticHit(int32 Slot, FHitResult& OutHit) const;
+
+	/** request static geometry trace along predicted path of projectile in slot */
+	void RequestTrace(int32 Slot);
+};
@@ -0,0 +1,94 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "StrategySimBenchmarkCommandlet.generated.h"
+
+class AStrategyBuilding_Brewery;
+
+/**
+ * Headless match simulation for measuring simulation throughput and balance.
+ * Loads the map into one or more independent worlds, feeds both breweries of each scripted waves and ticks the worlds
+ * at fixed timestep as fast as possible, with garbage collection on the engine's usual cadence,
+ * then writes simulation speed, time spent in each system and in garbage collection, peak memory
+ * and outcome of each match as JSON. Path requests per wave and flow field build times are reported for each match,
+ * -NoFlowField and -FlowFieldBudget=0 give numbers without flow fields and with single frame field builds.
+ * Character movement is engine code without a scope of ours; -Csv captures engine's CSV stats (CharacterMovement among them)
+ * into a file next to the report. -NoProjectileActors leaves simulated projectile actors in place between hits,
+ * comparing Projectiles time with and without it gives the cost of moving them.
+ *
+ * Usage: StrategyGame -run=StrategySimBenchmark -nullrhi [-Map=TowerDefenseMap] [-Minutes=5] [-Step=0.0333]
+ *        [-Seed=1] [-Worlds=1] [-WaveInterval=20] [-WaveSize=5] [-WaveGrowth=1] [-Batched] [-Output=File.json]
+ *        [-NoFlowField] [-FlowFieldBudget=1.0] [-Csv] [-NoProjectileActors]
+ */
+UCLASS()
+class UStrategySimBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+
+protected:
+	/** Scripted waves, same for both teams */
+	struct FWaveSchedule
+	{
+		/** time between waves, in simulated seconds */
+		float Interval;
+
+		/** minions in first wave */
+		int32 Size;
+
+		/** minions added to each next wave */
+		int32 Growth;
+
+		/** spawn waves in batched mode */
+		bool bBatched;
+	};
+
+	/** Single match, simulated in its own world */
+	struct FSimMatch
+	{
+		/** world match is played in */
+		UWorld* World;
+
+		/** seed of match */
+		int32 Seed;
+
+		/** simulated time */
+		float SimTime;
+
+		/** simulated time of next wave */
+		float NextWaveTime;
+
+		/** waves spawned so far */
+		int32 NumWaves;
+
+		/** frames simulated so far */
+		int32 NumFrames;
+
+		/** real time spent ticking this world */
+		double WallTime;
+
+		/** set once match is over or out of frames */
+		bool bDone;
+	};
+
+	/** advance match by one frame, returns false if match is over */
+	bool TickMatch(FSimMatch& Match, const FWaveSchedule& Schedule, float TimeStep);
+
+	/** build JSON report of single match */
+	TSharedRef<class FJsonObject> BuildMatchReport(const FSimMatch& Match) const;
+
+	/** load instance Index of map and begin play, returns world or NULL on failure */
+	UWorld* LoadWorld(const FString& MapName, int32 Seed, int32 Index);
+
+	/** give wave to director of each brewery */
+	void SpawnWave(UWorld* World, const FWaveSchedule& Schedule, int32 WaveIdx);
+
+	/** shut down and release loaded world */
+	void UnloadWorld(UWorld* World);
+};
@@ -0,0 +1,104 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategySimProfiler.generated.h"
+
+namespace EStrategySimStat
+{
+	enum Type
+	{
+		AI,
+		Sensing,
+		Projectiles,
+		Buildings,
+		MAX
+	};
+}
+
+/** simulation profiler is only compiled into builds which can run the benchmark commandlet */
+#define STRATEGY_SIM_PROFILER (!UE_BUILD_SHIPPING)
+
+/**
+ * Accumulates game thread time spent in each simulation system of one world.
+ * Disabled by default, enabled by headless benchmark; scopes don't look the profiler up unless some profiler is enabled.
+ */
+UCLASS()
+class UStrategySimProfiler : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategySimProfiler();
+
+	/** start or stop collecting times */
+	void SetEnabled(bool bEnable);
+
+	/** are times collected? */
+	FORCEINLINE bool IsEnabled() const { return bEnabled; }
+
+	/** are times collected by profiler of any world? */
+	FORCEINLINE static bool IsAnyEnabled() { return NumEnabled > 0; }
+
+	/** add time spent in system */
+	FORCEINLINE void AddCycles(EStrategySimStat::Type Stat, uint64 NumCycles) { Cycles[Stat] += NumCycles; }
+
+	/** get total time spent in system, in seconds */
+	double GetSeconds(EStrategySimStat::Type Stat) const;
+
+	/** clear collected times */
+	void Reset();
+
+	/** get display name of system */
+	static const TCHAR* GetStatName(EStrategySimStat::Type Stat);
+
+	// Begin USubsystem interface
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+protected:
+	/** number of enabled profilers in all worlds */
+	static int32 NumEnabled;
+
+	/** cycles spent in each system */
+	uint64 Cycles[EStrategySimStat::MAX];
+
+	/** set when times are collected */
+	bool bEnabled;
+};
+
+/** Adds time spent in its scope to world's simulation profiler. */
+struct FStrategySimProfileScope
+{
+	FORCEINLINE FStrategySimProfileScope(const UWorld* World, EStrategySimStat::Type InStat)
+		: Profiler(nullptr), Stat(InStat), StartCycles(0)
+	{
+		if (UStrategySimProfiler::IsAnyEnabled())
+		{
+			Begin(World);
+		}
+	}
+
+	FORCEINLINE ~FStrategySimProfileScope()
+	{
+		if (Profiler)
+		{
+			Profiler->AddCycles(Stat, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	/** start timing if profiler of world is enabled */
+	void Begin(const UWorld* World);
+
+	UStrategySimProfiler* Profiler;
+	EStrategySimStat::Type Stat;
+	uint64 StartCycles;
+};
+
+#if STRATEGY_SIM_PROFILER
+#define STRATEGY_SIM_PROFILE_SCOPE(World, Stat) FStrategySimProfileScope PREPROCESSOR_JOIN(SimProfileScope, __LINE__)(World, Stat)
+#else
+#define STRATEGY_SIM_PROFILE_SCOPE(World, Stat)
+#endif
@@ -0,0 +1,136 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategySpatialGrid.generated.h"
+
+class AStrategyChar;
+
+/** Stable reference to character registered in spatial grid, goes stale once the character leaves the grid. */
+struct FStrategyGridHandle
+{
+	/** slot in grid */
+	int32 Slot;
+
+	/** serial of slot when handle was taken */
+	uint32 Serial;
+
+	FStrategyGridHandle() : Slot(INDEX_NONE), Serial(0) {}
+};
+
+/**
+ * Uniform 2D grid of living characters, used to answer radius queries without walking every character in the world.
+ * Characters register themselves on BeginPlay and leave the grid when they die; cells are refreshed every frame.
+ */
+UCLASS(config=Game)
+class UStrategySpatialGrid : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategySpatialGrid();
+
+	// Begin USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/**
+	 * Add character to the grid.
+	 *
+	 * @param	InChar		The character to register.
+	 */
+	void RegisterChar(AStrategyChar* InChar);
+
+	/**
+	 * Remove character from the grid.
+	 *
+	 * @param	InChar		The character to unregister.
+	 */
+	void UnregisterChar(AStrategyChar* InChar);
+
+	/**
+	 * Find all registered characters within 2D radius.
+	 *
+	 * @param	Origin		Center of the query.
+	 * @param	Radius		Radius of the query, Z axis is ignored.
+	 * @param	Func		Called for every character inside the radius.
+	 */
+	void ForEachCharInRadius(const FVector& Origin, float Radius, TFunctionRef<void(AStrategyChar*)> Func) const;
+
+	/**
+	 * Find all registered characters within 2D radius.
+	 *
+	 * @param	Origin		Center of the query.
+	 * @param	Radius		Radius of the query, Z axis is ignored.
+	 * @param	OutChars	Receives found characters.
+	 */
+	void QueryRadius(const FVector& Origin, float Radius, TArray<AStrategyChar*>& OutChars) const;
+
+	/** get number of registered characters */
+	int32 GetNumChars() const;
+
+	/** get number of slots, including free ones; slots are indexed 0..GetNumSlots()-1 */
+	FORCEINLINE int32 GetNumSlots() const { return Entries.Num(); }
+
+	/** get handle to registered character, invalid handle if character is not in the grid */
+	FStrategyGridHandle GetHandle(const AStrategyChar* InChar) const;
+
+	/** get character for handle, NULL if handle went stale */
+	FORCEINLINE AStrategyChar* ResolveHandle(const FStrategyGridHandle& Handle) const
+	{
+		return (Entries.IsValidIndex(Handle.Slot) && Entries[Handle.Slot].Serial == Handle.Serial) ? Entries[Handle.Slot].Char : nullptr;
+	}
+
+protected:
+	// Begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem interface
+
+	/** Size of single grid cell */
+	UPROPERTY(config)
+	float CellSize;
+
+	/** single registered character */
+	struct FGridEntry
+	{
+		/** registered character, removed from grid in EndPlay */
+		AStrategyChar* Char;
+
+		/** cell character is currently stored in */
+		FIntPoint Cell;
+
+		/** index in cell's list */
+		int32 IndexInCell;
+
+		/** bumped every time character leaves this slot, invalidates handles */
+		uint32 Serial;
+	};
+
+	/** all registered characters, free slots are reused */
+	TArray<FGridEntry> Entries;
+
+	/** list of unused slots in Entries */
+	TArray<int32> FreeEntries;
+
+	/** cells with at least one character, hold indices to Entries */
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** number of registered characters */
+	int32 NumChars;
+
+	/** get cell for given location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** add entry to cell's list */
+	void AddToCell(int32 EntryIndex, const FIntPoint& Cell);
+
+	/** remove entry from cell's list */
+	void RemoveFromCell(int32 EntryIndex);
+};
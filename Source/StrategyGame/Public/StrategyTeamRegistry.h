@@ -0,0 +1,116 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyTeamRegistry.generated.h"
+
+/** Relation between two actors */
+namespace EStrategyTeamRelation
+{
+	enum Type
+	{
+		/** at least one of actors doesn't belong to any team */
+		None,
+		Friendly,
+		Enemy,
+	};
+}
+
+/**
+ * Team of every actor registered by gameplay code, stored in sparse map keyed by actor, and relations
+ * between all teams. Team queries on hot paths become two map lookups instead of interface casts.
+ * Actors which are not registered (yet) are resolved through IStrategyTeamInterface.
+ */
+UCLASS()
+class UStrategyTeamRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UStrategyTeamRegistry();
+
+	// Begin USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** is registry used by team queries? */
+	static bool IsEnabled();
+
+	/**
+	 * Store team of actor, needs to be called again whenever actor's team changes.
+	 *
+	 * @param	Actor		The actor to register.
+	 * @param	TeamNum		Current team of actor.
+	 */
+	void SetTeam(const AActor* Actor, uint8 TeamNum);
+
+	/**
+	 * Forget team of actor, must be called before actor is destroyed.
+	 *
+	 * @param	Actor		The actor to unregister.
+	 */
+	void RemoveActor(const AActor* Actor);
+
+	/**
+	 * Override relation between two teams, applies both ways.
+	 *
+	 * @param	TeamA		First team.
+	 * @param	TeamB		Second team.
+	 * @param	Relation	New relation.
+	 */
+	void SetRelation(uint8 TeamA, uint8 TeamB, EStrategyTeamRelation::Type Relation);
+
+	/**
+	 * Grow relation table, new teams get default relations.
+	 *
+	 * @param	NewNumTeams		Number of teams, including neutral one.
+	 */
+	void SetNumTeams(int32 NewNumTeams);
+
+	/** get relation between two actors */
+	FORCEINLINE EStrategyTeamRelation::Type GetRelation(const AActor* ActorA, const AActor* ActorB) const
+	{
+		const uint8 TeamA = GetTeam(ActorA);
+		const uint8 TeamB = GetTeam(ActorB);
+		if (TeamA < NumTeams && TeamB < NumTeams)
+		{
+			return (EStrategyTeamRelation::Type)Relations[TeamA * NumTeams + TeamB];
+		}
+
+		return GetDefaultRelation(TeamA, TeamB);
+	}
+
+	/** get team of actor, NoTeam if it doesn't implement team interface */
+	FORCEINLINE uint8 GetTeam(const AActor* Actor) const
+	{
+		const uint8* const TeamNum = Actor != nullptr ? ActorTeams.Find(Actor) : nullptr;
+		return TeamNum != nullptr ? *TeamNum : GetUnregisteredTeam(Actor);
+	}
+
+	/** relation of two actors resolved through team interface, without registry */
+	static EStrategyTeamRelation::Type GetRelationByInterface(const AActor* ActorA, const AActor* ActorB);
+
+	/** team value of actors without team */
+	static const uint8 NoTeam = 0xFF;
+
+protected:
+	/** first team value which can't be registered */
+	static const uint8 NotRegistered = 0xFE;
+
+	/** team of each registered actor, actors must be removed before they are destroyed */
+	TMap<const AActor*, uint8> ActorTeams;
+
+	/** NumTeams x NumTeams relation table */
+	TArray<uint8> Relations;
+
+	/** number of teams in relation table */
+	int32 NumTeams;
+
+	/** get team of actor not found in registry */
+	static uint8 GetUnregisteredTeam(const AActor* Actor);
+
+	/** get default relation of two teams, also used for teams not covered by relation table */
+	static EStrategyTeamRelation::Type GetDefaultRelation(uint8 TeamA, uint8 TeamB);
+};
@@ -18,6 +18,22 @@ namespace EStrategyTeam
 	};
 }
 
+UENUM()
+namespace EStrategyTowerTargeting
+{
+	enum Type
+	{
+		/** closest enemy to tower */
+		Nearest,
+
+		/** enemy with least health, closest one on tie */
+		LowestHealth,
+
+		/** enemy closest to brewery defended by tower */
+		FirstInPath,
+	};
+}
+
 namespace EGameKey
 {
 	enum Type
@@ -161,7 +177,7 @@ struct FBuffData
 	*
 	* @param	PawnData		Data to apply.
 	*/
-	void ApplyBuff(struct FPawnData& PawnData);
+	void ApplyBuff(struct FPawnData& PawnData) const;
 };
 
 struct FPlayerData
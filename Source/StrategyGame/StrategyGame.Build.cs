@@ -22,7 +22,8 @@ public class StrategyGame : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(
 			new string[] {
-				"StrategyGameLoadingScreen"
+				"StrategyGameLoadingScreen",
+				"Json",
 			}
 		);
 